@@ -42,11 +42,17 @@
 #include <QMainWindow>
 #include <QVBoxLayout>
 #include <QPushButton>
+#include <QThread>
+#include "repositories/connection_pool.h"
+#include "repositories/schema_migrator.h"
+#include "repositories/storage_profile.h"
 #include "ui/views/login_view.h"
 #include "services/user_service.h"
 #include "services/word_service.h"
 #include "services/review_service.h"
 #include "services/statistics_service.h"
+#include "services/write_behind_queue.h"
+#include "services/due_queue.h"
 
 // Project Structure:
 /*
@@ -54,21 +60,35 @@ inherit_memorizing_word_system/
 ├── models/
 │   ├── user.cpp/h
 │   ├── word.cpp/h
-│   └── review_session.cpp/h
+│   ├── review_session.cpp/h
+│   ├── scheduler.cpp/h
+│   └── compact_word_store.cpp/h
 ├── repositories/
 │   ├── base_repository.cpp/h
+│   ├── connection_pool.cpp/h
+│   ├── schema_migrator.cpp/h
+│   ├── storage_profile.cpp/h
 │   ├── user_repository.cpp/h
 │   └── word_repository.cpp/h
 ├── services/
 │   ├── user_service.cpp/h
 │   ├── word_service.cpp/h
 │   ├── review_service.cpp/h
-│   └── statistics_service.cpp/h
+│   ├── statistics_service.cpp/h
+│   ├── write_behind_queue.cpp/h
+│   ├── word_cache.cpp/h
+│   ├── prefix_index.cpp/h
+│   ├── due_queue.cpp/h
+│   ├── distractor_index.cpp/h
+│   ├── answer_grader.cpp/h
+│   └── leaderboard.cpp/h
 ├── ui/views/
 │   ├── login_view.cpp/h
 │   ├── vocabulary_view.cpp/h
 │   ├── review_view.cpp/h
 │   └── statistics_view.cpp/h
+├── ui/models/
+│   └── word_table_model.cpp/h
 ├── resources.qrc
 └── main.cpp
 */
@@ -113,70 +133,47 @@ int main(int argc, char *argv[]) {
         return 1;
     }
     
-    // Initialize database schema
-    QSqlQuery query;
-    
-    // Users table
-    if (!query.exec("CREATE TABLE IF NOT EXISTS users ("
-                   "username TEXT PRIMARY KEY,"
-                   "password TEXT,"
-                   "total_score INTEGER DEFAULT 0,"
-                   "days_streak INTEGER DEFAULT 0,"
-                   "total_words_learned INTEGER DEFAULT 0,"
-                   "last_checkin_date TEXT,"
-                   "created_at TEXT"
-                   ")")) {
-        QMessageBox::critical(nullptr, "Database Error", 
-                            QString("Could not create users table. Error: %1")
-                            .arg(query.lastError().text()));
-        return 1;
+    // Apply the storage profile (journal mode, fsync policy, caches)
+    StorageProfile storageProfile = StorageProfile::fromEnvironment();
+    if (!storageProfile.apply(db)) {
+        qWarning() << "Storage profile" << storageProfile.name << "was only partially applied";
     }
+    qDebug() << "Storage profile:" << storageProfile.name;
     
-    // Words table
-    if (!query.exec("CREATE TABLE IF NOT EXISTS words ("
-                   "english TEXT PRIMARY KEY,"
-                   "part_of_speech TEXT,"
-                   "chinese TEXT,"
-                   "frequency INTEGER DEFAULT 0,"
-                   "correct_count INTEGER DEFAULT 0,"
-                   "total_attempts INTEGER DEFAULT 0"
-                   ")")) {
+    // Initialize database schema
+    try {
+        SchemaMigrator migrator(db);
+        migrator.migrate();
+    } catch (const std::exception& e) {
         QMessageBox::critical(nullptr, "Database Error", 
-                            QString("Could not create words table. Error: %1")
-                            .arg(query.lastError().text()));
+                            QString("Could not initialize database schema. Error: %1")
+                            .arg(e.what()));
         return 1;
     }
     
-    // Word definitions table
-    if (!query.exec("CREATE TABLE IF NOT EXISTS word_definitions ("
-                   "english TEXT,"
-                   "definition_type TEXT,"
-                   "content TEXT,"
-                   "FOREIGN KEY(english) REFERENCES words(english) ON DELETE CASCADE"
-                   ")")) {
-        QMessageBox::critical(nullptr, "Database Error", 
-                            QString("Could not create word_definitions table. Error: %1")
-                            .arg(query.lastError().text()));
-        return 1;
-    }
+    // Share the database with worker threads: one connection per thread,
+    // a reader connection for each core
+    ConnectionPool::instance().initialize(db, QThread::idealThreadCount(), storageProfile);
     
-    // Word categories table
-    if (!query.exec("CREATE TABLE IF NOT EXISTS word_categories ("
-                   "english TEXT,"
-                   "category TEXT,"
-                   "FOREIGN KEY(english) REFERENCES words(english) ON DELETE CASCADE"
-                   ")")) {
-        QMessageBox::critical(nullptr, "Database Error", 
-                            QString("Could not create word_categories table. Error: %1")
-                            .arg(query.lastError().text()));
-        return 1;
-    }
+    // Score and review writes are persisted in the background
+    auto writeQueue = std::make_unique<WriteBehindQueue>();
     
     // Initialize services
-    auto userService = std::make_unique<UserService>();
+    auto userService = std::make_unique<UserService>(writeQueue.get());
+    // Rankings are answered from memory from here on
+    userService->loadLeaderboard();
     auto wordService = std::make_unique<WordService>();
-    auto reviewService = std::make_unique<ReviewService>();
-    auto statisticsService = std::make_unique<StatisticsService>();
+    // Due dates of the logged-in user's cards, shared by review and statistics
+    auto dueQueue = std::make_unique<DueQueue>();
+    auto reviewService = std::make_unique<ReviewService>(writeQueue.get(), wordService->getCache(),
+                                                         dueQueue.get());
+    auto statisticsService = std::make_unique<StatisticsService>(dueQueue.get());
+    
+    // A prefetched review session may hold an edited or deleted word
+    wordService->addChangeListener(
+        [reviewService = reviewService.get()](const std::string& english) {
+            reviewService->invalidatePrefetchFor(english);
+        });
     
     // Create and show login view
     LoginView loginView(userService.get());
@@ -185,6 +182,23 @@ int main(int argc, char *argv[]) {
     // Connect login success to main window creation
     QObject::connect(&loginView, &LoginView::loginSuccessful, 
         [&](const QString& username) {
+            // Headword completion runs from memory after this
+            wordService->loadPrefixIndex();
+            // Cards last scheduled by another engine get its due dates
+            try {
+                int changed = reviewService->applyScheduler(username.toStdString());
+                if (changed > 0) {
+                    qDebug() << "Rescheduled" << changed << "cards with"
+                             << QString::fromStdString(reviewService->getScheduler().name());
+                }
+            } catch (const std::exception& e) {
+                qWarning() << "Could not reschedule cards:" << e.what();
+            }
+            // Sessions and due counts read due dates from memory after this
+            reviewService->loadDueQueue(username.toStdString());
+            // Have the first review session ready before it is asked for
+            reviewService->prefetchNextSession(username.toStdString());
+            
             // Create and show main selection window
             auto mainWindow = new QMainWindow();
             auto centralWidget = new QWidget(mainWindow);
@@ -243,6 +257,9 @@ int main(int argc, char *argv[]) {
                         ).arg(stats.daysStreak)
                          .arg(currentUser.calculateCheckInPoints())
                          .arg(stats.totalScore);
+                        if (auto rank = userService->getCurrentRank()) {
+                            message += QString("\n当前排名：第 %1 名").arg(*rank);
+                        }
                         
                         QMessageBox::information(nullptr, "每日签到", message);
                     } catch (const std::exception& e) {
@@ -255,5 +272,10 @@ int main(int argc, char *argv[]) {
             mainWindow->show();
         });
     
-    return app.exec();
+    int exitCode = app.exec();
+    
+    // Flush pending writes before the connections go away
+    writeQueue->stop();
+    ConnectionPool::instance().shutdown();
+    return exitCode;
 }
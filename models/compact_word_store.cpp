@@ -0,0 +1,139 @@
+#include "compact_word_store.h"
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+    constexpr std::string_view kPartOfSpeechNames[] = {
+        "", "n.", "v.", "adj.", "adv.", "prep.", "conj.", "pron.", "art.", ""
+    };
+}
+
+PartOfSpeech parsePartOfSpeech(std::string_view text) {
+    if (text.empty()) return PartOfSpeech::None;
+    for (size_t i = 1; i < std::size(kPartOfSpeechNames) - 1; ++i) {
+        if (kPartOfSpeechNames[i] == text) return static_cast<PartOfSpeech>(i);
+    }
+    return PartOfSpeech::Other;
+}
+
+std::string_view partOfSpeechName(PartOfSpeech partOfSpeech) {
+    return kPartOfSpeechNames[static_cast<size_t>(partOfSpeech)];
+}
+
+CompactWordStore::Index CompactWordStore::add(const Word& word) {
+    static_assert(sizeof(Record) == 16, "Record layout grew");
+    if (!fits(word)) {
+        throw std::length_error("Word is over a CompactWordStore limit");
+    }
+    
+    Record record{};
+    record.textOffset = static_cast<uint32_t>(text.size());
+    record.englishLength = static_cast<uint16_t>(word.getEnglish().size());
+    text.append(word.getEnglish());
+    text.append(word.getChinese());
+    record.partOfSpeech = parsePartOfSpeech(word.getPartOfSpeech());
+    if (record.partOfSpeech == PartOfSpeech::Other) {
+        auto [it, inserted] = otherPartOfSpeechIds.emplace(
+            word.getPartOfSpeech(), static_cast<uint32_t>(otherPartsOfSpeech.size()));
+        if (inserted) {
+            otherPartsOfSpeech.push_back(word.getPartOfSpeech());
+        }
+        record.otherPartOfSpeech = static_cast<uint8_t>(it->second);
+    }
+    record.correctCount = word.getStats().correctCount;
+    record.totalAttempts = word.getStats().totalAttempts;
+    records.push_back(record);
+    return static_cast<Index>(records.size() - 1);
+}
+
+bool CompactWordStore::fits(const Word& word) const {
+    Usage current = usage();
+    return fits(word, current);
+}
+
+size_t CompactWordStore::countFitting(const std::vector<Word>& words) const {
+    Usage current = usage();
+    size_t count = 0;
+    for (const auto& word : words) {
+        if (fits(word, current)) {
+            count++;
+        }
+    }
+    return count;
+}
+
+CompactWordStore::Usage CompactWordStore::usage() const {
+    return {text.size(), records.size(), {}};
+}
+
+bool CompactWordStore::fits(const Word& word, Usage& usage) const {
+    constexpr size_t kMaxEnglish = std::numeric_limits<uint16_t>::max();
+    constexpr size_t kMaxOthers = std::numeric_limits<uint8_t>::max();
+    constexpr size_t kMaxOffset = std::numeric_limits<uint32_t>::max();
+    if (word.getEnglish().size() > kMaxEnglish) {
+        return false;
+    }
+    
+    size_t textBytes = word.getEnglish().size() + word.getChinese().size();
+    if (textBytes > kMaxOffset - usage.textBytes || usage.records >= kMaxOffset) {
+        return false;
+    }
+    
+    // Other parts of speech get one-byte intern ids
+    const std::string& partOfSpeech = word.getPartOfSpeech();
+    bool newOther = parsePartOfSpeech(partOfSpeech) == PartOfSpeech::Other
+        && !otherPartOfSpeechIds.count(partOfSpeech)
+        && !usage.newOtherPartsOfSpeech.count(partOfSpeech);
+    if (newOther) {
+        if (otherPartsOfSpeech.size() + usage.newOtherPartsOfSpeech.size() > kMaxOthers) {
+            return false;
+        }
+        usage.newOtherPartsOfSpeech.insert(partOfSpeech);
+    }
+    
+    usage.textBytes += textBytes;
+    usage.records++;
+    return true;
+}
+
+void CompactWordStore::clear() {
+    text.clear();
+    records.clear();
+    otherPartsOfSpeech.clear();
+    otherPartOfSpeechIds.clear();
+}
+
+void CompactWordStore::reserve(size_t words, size_t textBytes) {
+    records.reserve(words);
+    text.reserve(textBytes);
+}
+
+void CompactWordStore::shrinkToFit() {
+    text.shrink_to_fit();
+    records.shrink_to_fit();
+}
+
+std::string_view CompactWordStore::partOfSpeech(Index i) const {
+    const Record& record = records[i];
+    if (record.partOfSpeech == PartOfSpeech::Other) {
+        return otherPartsOfSpeech[record.otherPartOfSpeech];
+    }
+    return partOfSpeechName(record.partOfSpeech);
+}
+
+double CompactWordStore::accuracy(Index i) const {
+    const Record& record = records[i];
+    return record.totalAttempts > 0
+        ? static_cast<double>(record.correctCount) / record.totalAttempts : 0.0;
+}
+
+size_t CompactWordStore::memoryUsage() const {
+    // Containers and their buffers; the intern table is small and is
+    // counted by entry, ignoring hash table overhead
+    size_t bytes = sizeof(*this) + text.capacity() + records.capacity() * sizeof(Record);
+    for (const auto& name : otherPartsOfSpeech) {
+        bytes += 2 * (sizeof(std::string) + name.capacity());
+    }
+    return bytes;
+}
@@ -0,0 +1,104 @@
+#ifndef COMPACT_WORD_STORE_H
+#define COMPACT_WORD_STORE_H
+
+#include "word.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// The parts of speech offered by WordDialog; anything else is Other and
+// keeps its text in the store's intern table
+enum class PartOfSpeech : uint8_t {
+    None,
+    Noun,
+    Verb,
+    Adjective,
+    Adverb,
+    Preposition,
+    Conjunction,
+    Pronoun,
+    Article,
+    Other
+};
+
+PartOfSpeech parsePartOfSpeech(std::string_view text);
+// "n.", "v.", ...; empty for None and Other
+std::string_view partOfSpeechName(PartOfSpeech partOfSpeech);
+
+// Many words held for display in the vocabulary list, without a Word
+// object each. Only what the list shows is kept: english, chinese, part of
+// speech and the answer counts. All text lives back to back in one arena
+// and records refer to it by offset; part of speech is a one-byte enum.
+// Per word that is one 16-byte record plus its text, instead of five
+// heap-allocated containers.
+//
+// Append-only. Limits: 64 KiB of english per word, 256 distinct Other parts
+// of speech and 4 GiB of text in all.
+class CompactWordStore {
+public:
+    using Index = uint32_t;
+
+    // Throws std::length_error, adding nothing, if the word does not fit
+    Index add(const Word& word);
+    bool fits(const Word& word) const;
+    // How many of words add() would accept if they were added in order
+    size_t countFitting(const std::vector<Word>& words) const;
+    void clear();
+    void reserve(size_t words, size_t textBytes = 0);
+    // Drops spare capacity once no more words are expected
+    void shrinkToFit();
+    size_t size() const { return records.size(); }
+    bool empty() const { return records.empty(); }
+
+    std::string_view english(Index i) const {
+        return {text.data() + records[i].textOffset, records[i].englishLength};
+    }
+    // Runs from the end of english to the start of the next word's text
+    std::string_view chinese(Index i) const {
+        size_t begin = records[i].textOffset + records[i].englishLength;
+        size_t end = i + 1 < records.size() ? records[i + 1].textOffset : text.size();
+        return {text.data() + begin, end - begin};
+    }
+    std::string_view partOfSpeech(Index i) const;
+    PartOfSpeech partOfSpeechKind(Index i) const { return records[i].partOfSpeech; }
+    int correctCount(Index i) const { return records[i].correctCount; }
+    int totalAttempts(Index i) const { return records[i].totalAttempts; }
+    // As Word::LearningStats::getAccuracy
+    double accuracy(Index i) const;
+
+    // Bytes held by the store, including unused capacity
+    size_t memoryUsage() const;
+
+private:
+    // A word's english and chinese are adjacent in the arena
+    struct Record {
+        uint32_t textOffset;
+        uint16_t englishLength;
+        PartOfSpeech partOfSpeech;
+        uint8_t otherPartOfSpeech;      // Intern id when partOfSpeech is Other
+        int32_t correctCount;
+        int32_t totalAttempts;
+    };
+
+    // What the limits apply to, so fits() can look ahead over several words
+    struct Usage {
+        size_t textBytes;
+        size_t records;
+        std::unordered_set<std::string> newOtherPartsOfSpeech;
+    };
+
+    Usage usage() const;
+    // Accounts for the word in usage if it fits
+    bool fits(const Word& word, Usage& usage) const;
+
+    std::string text;
+    std::vector<Record> records;
+    std::vector<std::string> otherPartsOfSpeech;
+    std::unordered_map<std::string, uint32_t> otherPartOfSpeechIds;
+};
+
+#endif // COMPACT_WORD_STORE_H
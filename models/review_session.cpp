@@ -1,8 +1,11 @@
 #include "review_session.h"
 #include <algorithm>
+#include <utility>
 
-ReviewSession::ReviewSession(const std::vector<Word>& words)
-    : currentIndex(0), correctCount(0), totalCount(0),
+ReviewSession::ReviewSession(const std::vector<Word>& words,
+                             std::shared_ptr<const SchedulerEngine> scheduler,
+                             const std::map<std::string, CardState>& cards)
+    : scheduler(std::move(scheduler)), currentIndex(0), correctCount(0), totalCount(0),
       startTime(std::chrono::system_clock::now()) {
     // Initialize random number generator with random device
     std::random_device rd;
@@ -11,7 +14,8 @@ ReviewSession::ReviewSession(const std::vector<Word>& words)
     // Create review items from words
     items.reserve(words.size());
     for (const auto& word : words) {
-        items.emplace_back(word);
+        auto card = cards.find(word.getEnglish());
+        items.emplace_back(word, card != cards.end() ? card->second : CardState{});
     }
     
     shuffle();
@@ -23,27 +27,34 @@ void ReviewSession::recordAttempt(bool correct) {
     auto& item = items[currentIndex];
     item.reviewed = true;
     item.correct = correct;
+    item.answeredAt = std::chrono::system_clock::now();
+    item.responseTime = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - itemShownAt);
     
     // Update mastery level based on correctness
     if (correct) {
-        if (item.masteryLevel < 4) {
-            item.masteryLevel++;
+        if (item.card.masteryLevel < 4) {
+            item.card.masteryLevel++;
         }
         correctCount++;
     } else {
-        if (item.masteryLevel > 1) {
-            item.masteryLevel--;
+        if (item.card.masteryLevel > 1) {
+            item.card.masteryLevel--;
         }
     }
     
-    item.updateNextReviewDate();
+    scheduler->review(item.card, correct,
+                      std::chrono::system_clock::to_time_t(item.answeredAt));
+    item.nextReviewDate = std::chrono::system_clock::from_time_t(item.card.nextReviewAt);
     totalCount++;
     currentIndex++;
+    itemShownAt = std::chrono::steady_clock::now();
 }
 
 void ReviewSession::shuffle() {
     std::shuffle(items.begin(), items.end(), rng);
     currentIndex = 0;
+    itemShownAt = std::chrono::steady_clock::now();
 }
 
 double ReviewSession::getAccuracy() const {
@@ -1,8 +1,12 @@
 #ifndef REVIEW_SESSION_H
 #define REVIEW_SESSION_H
 
+#include "scheduler.h"
 #include "word.h"
 #include <vector>
+#include <map>
+#include <memory>
+#include <string>
 #include <chrono>
 #include <random>
 
@@ -10,40 +14,35 @@ class ReviewSession {
 public:
     struct ReviewItem {
         Word word;
-        int masteryLevel;  // 1-4: beginner, familiar, mastered, expert
+        CardState card;    // Mastery level and scheduler state
         std::chrono::system_clock::time_point nextReviewDate;
         bool reviewed;     // Whether this item has been reviewed in current session
         bool correct;      // Whether the last review was correct
+        std::chrono::system_clock::time_point answeredAt;
+        std::chrono::milliseconds responseTime{0};  // From being shown to answered
         
-        ReviewItem(const Word& w, int level = 1)
-            : word(w), masteryLevel(level), reviewed(false), correct(false) {
-            updateNextReviewDate();
-        }
-        
-        void updateNextReviewDate() {
-            auto now = std::chrono::system_clock::now();
-            // Spaced repetition intervals: 1 day, 3 days, 7 days, 14 days
-            int daysToAdd = 0;
-            switch (masteryLevel) {
-                case 1: daysToAdd = 1; break;
-                case 2: daysToAdd = 3; break;
-                case 3: daysToAdd = 7; break;
-                default: daysToAdd = 14; break;
-            }
-            nextReviewDate = now + std::chrono::hours(24 * daysToAdd);
-        }
+        ReviewItem(const Word& w, const CardState& state = {})
+            : word(w), card(state),
+              nextReviewDate(std::chrono::system_clock::from_time_t(state.nextReviewAt)),
+              reviewed(false), correct(false) {}
     };
 
 private:
     std::vector<ReviewItem> items;
+    std::shared_ptr<const SchedulerEngine> scheduler;
     size_t currentIndex;
     std::mt19937 rng;
     int correctCount;
     int totalCount;
     std::chrono::system_clock::time_point startTime;
+    std::chrono::steady_clock::time_point itemShownAt;
 
 public:
-    ReviewSession(const std::vector<Word>& words);
+    // cards carries the stored state of words already being learned; answers
+    // are scheduled by scheduler
+    ReviewSession(const std::vector<Word>& words,
+                  std::shared_ptr<const SchedulerEngine> scheduler,
+                  const std::map<std::string, CardState>& cards = {});
     
     // Session control
     bool hasNext() const { return currentIndex < items.size(); }
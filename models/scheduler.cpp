@@ -0,0 +1,168 @@
+#include "scheduler.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr double kSecondsPerDay = 86400.0;
+constexpr double kMinIntervalDays = 1.0;
+
+// Due time of a card reviewed at lastReviewAt; cards that were never
+// reviewed stay due immediately
+inline int64_t dueAt(int64_t lastReviewAt, double intervalDays) {
+    return lastReviewAt == 0
+        ? 0
+        : lastReviewAt + static_cast<int64_t>(std::max(intervalDays, kMinIntervalDays)
+                                              * kSecondsPerDay);
+}
+
+// SM-2 ease factor <-> the shared 1-10 difficulty scale
+constexpr double kInitialDifficulty = 3.0;
+constexpr double kInitialEase = 2.5;
+constexpr double kEasePerDifficulty = 0.2;
+constexpr double kMinEase = 1.3;
+
+double easeFromDifficulty(double difficulty) {
+    if (difficulty <= 0) difficulty = kInitialDifficulty;
+    return std::max(kMinEase, kInitialEase + kEasePerDifficulty * (kInitialDifficulty - difficulty));
+}
+
+double difficultyFromEase(double ease) {
+    return std::clamp(kInitialDifficulty - (ease - kInitialEase) / kEasePerDifficulty, 1.0, 10.0);
+}
+
+// FSRS forgetting curve: R(t, S) = (1 + kFactor * t / S) ^ kDecay, chosen so
+// that R(S, S) = 0.9
+constexpr double kDecay = -0.5;
+constexpr double kFactor = 19.0 / 81.0;
+constexpr double kMinStability = 0.01;
+
+} // namespace
+
+void CardBatch::reserve(size_t count) {
+    words.reserve(count);
+    stability.reserve(count);
+    lastReviewAt.reserve(count);
+    nextReviewAt.reserve(count);
+}
+
+void CardBatch::clear() {
+    words.clear();
+    stability.clear();
+    lastReviewAt.clear();
+    nextReviewAt.clear();
+}
+
+std::unique_ptr<SchedulerEngine> SchedulerEngine::create(const std::string& name) {
+    if (name == "sm2") return std::make_unique<Sm2Scheduler>();
+    if (name == "fsrs") return std::make_unique<FsrsScheduler>();
+    return nullptr;
+}
+
+Sm2Scheduler::Sm2Scheduler(double intervalModifier)
+    : intervalModifier(std::max(intervalModifier, 0.0)) {}
+
+void Sm2Scheduler::review(CardState& card, bool correct, int64_t now) const {
+    // A correct answer is graded 4, a wrong one 1
+    double ease = easeFromDifficulty(card.difficulty);
+    double interval;
+    if (correct) {
+        if (card.reps == 0) {
+            interval = 1.0;
+        } else if (card.reps == 1) {
+            interval = 6.0;
+        } else {
+            interval = std::round(std::max(card.stability, kMinIntervalDays) * ease);
+        }
+        card.reps++;
+    } else {
+        if (card.lastReviewAt != 0) {
+            card.lapses++;
+        }
+        card.reps = 0;
+        interval = 1.0;
+        ease = std::max(kMinEase, ease - 0.54);
+    }
+
+    card.stability = interval;
+    card.difficulty = difficultyFromEase(ease);
+    card.lastReviewAt = now;
+    card.nextReviewAt = dueAt(now, interval * intervalModifier);
+}
+
+void Sm2Scheduler::reschedule(CardBatch& batch) const {
+    const size_t count = batch.size();
+    const double* stability = batch.stability.data();
+    const int64_t* last = batch.lastReviewAt.data();
+    int64_t* next = batch.nextReviewAt.data();
+    const double modifier = intervalModifier;
+    for (size_t i = 0; i < count; ++i) {
+        next[i] = dueAt(last[i], stability[i] * modifier);
+    }
+}
+
+const FsrsScheduler::Weights FsrsScheduler::kDefaultWeights = {
+    0.4872, 1.4003, 3.7145, 13.8206, 5.1618, 1.2298, 0.8975, 0.031, 1.6474,
+    0.1367, 1.0461, 2.1072, 0.0793, 0.3246, 1.587, 0.2272, 2.8755
+};
+
+FsrsScheduler::FsrsScheduler(double desiredRetention, const Weights& weights)
+    : desiredRetention(std::clamp(desiredRetention, 0.5, 0.99)), w(weights),
+      intervalFactor((std::pow(this->desiredRetention, 1.0 / kDecay) - 1.0) / kFactor) {}
+
+double FsrsScheduler::retrievability(double elapsedDays, double stability) const {
+    return std::pow(1.0 + kFactor * elapsedDays / stability, kDecay);
+}
+
+double FsrsScheduler::intervalDays(double stability) const {
+    return stability * intervalFactor;
+}
+
+void FsrsScheduler::review(CardState& card, bool correct, int64_t now) const {
+    // Pass/fail maps to FSRS's Good (3) and Again (1); the Hard penalty and
+    // Easy bonus weights (w15, w16) are unused
+    const double grade = correct ? 3.0 : 1.0;
+
+    if (card.lastReviewAt == 0 || card.stability <= 0) {
+        card.stability = correct ? w[2] : w[0];
+        card.difficulty = std::clamp(w[4] - (grade - 3.0) * w[5], 1.0, 10.0);
+        card.reps = correct ? 1 : 0;
+    } else {
+        double elapsed = std::max(0.0, (now - card.lastReviewAt) / kSecondsPerDay);
+        double s = std::max(card.stability, kMinStability);
+        double d = card.difficulty > 0 ? card.difficulty : w[4];
+        double r = retrievability(elapsed, s);
+
+        if (correct) {
+            card.stability = s * (1.0 + std::exp(w[8]) * (11.0 - d) * std::pow(s, -w[9])
+                                        * (std::exp(w[10] * (1.0 - r)) - 1.0));
+            card.reps++;
+        } else {
+            double relearned = w[11] * std::pow(d, -w[12]) * (std::pow(s + 1.0, w[13]) - 1.0)
+                               * std::exp(w[14] * (1.0 - r));
+            card.stability = std::min(s, relearned);
+            card.reps = 0;
+            card.lapses++;
+        }
+
+        // Difficulty moves with the grade and reverts towards the initial
+        // difficulty of a Good answer
+        double next = d - w[6] * (grade - 3.0);
+        card.difficulty = std::clamp(w[7] * w[4] + (1.0 - w[7]) * next, 1.0, 10.0);
+    }
+
+    card.stability = std::max(card.stability, kMinStability);
+    card.lastReviewAt = now;
+    card.nextReviewAt = dueAt(now, intervalDays(card.stability));
+}
+
+void FsrsScheduler::reschedule(CardBatch& batch) const {
+    const size_t count = batch.size();
+    const double* stability = batch.stability.data();
+    const int64_t* last = batch.lastReviewAt.data();
+    int64_t* next = batch.nextReviewAt.data();
+    const double factor = intervalFactor;
+    for (size_t i = 0; i < count; ++i) {
+        next[i] = dueAt(last[i], stability[i] * factor);
+    }
+}
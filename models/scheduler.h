@@ -0,0 +1,92 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Scheduling state of one card, as stored in learning_records. Times are
+// epoch seconds; lastReviewAt == 0 means the card was never reviewed.
+struct CardState {
+    int masteryLevel = 1;     // 1-4 as shown to the user; engines leave it alone
+    double stability = 0.0;   // Days the card is expected to be remembered
+    double difficulty = 0.0;  // 1 (easy) to 10 (hard); 0 until first review
+    int reps = 0;             // Correct answers since the last lapse
+    int lapses = 0;           // Times the card was forgotten
+    int64_t lastReviewAt = 0;
+    int64_t nextReviewAt = 0;
+};
+
+// A user's cards as parallel arrays, so rescheduling is one tight loop per
+// field that the compiler can vectorize. words identify the cards.
+struct CardBatch {
+    std::vector<std::string> words;
+    std::vector<double> stability;
+    std::vector<int64_t> lastReviewAt;
+    std::vector<int64_t> nextReviewAt;
+
+    size_t size() const { return words.size(); }
+    void reserve(size_t count);
+    void clear();
+};
+
+// Spaced-repetition algorithm. review() updates a card after an answer;
+// reschedule() recomputes due dates from stored state only, e.g. after a
+// parameter change. Engines are immutable and safe to share across threads.
+class SchedulerEngine {
+public:
+    virtual ~SchedulerEngine() = default;
+
+    virtual std::string name() const = 0;
+    virtual void review(CardState& card, bool correct, int64_t now) const = 0;
+    virtual void reschedule(CardBatch& batch) const = 0;
+
+    // "sm2" or "fsrs" with default parameters; nullptr for other names
+    static std::unique_ptr<SchedulerEngine> create(const std::string& name);
+};
+
+// SuperMemo 2. stability holds the current interval in days; the ease
+// factor is derived from difficulty (difficulty 3 is SM-2's initial 2.5).
+class Sm2Scheduler : public SchedulerEngine {
+public:
+    // Scales every interval, like Anki's interval modifier
+    explicit Sm2Scheduler(double intervalModifier = 1.0);
+
+    std::string name() const override { return "sm2"; }
+    void review(CardState& card, bool correct, int64_t now) const override;
+    void reschedule(CardBatch& batch) const override;
+
+private:
+    double intervalModifier;
+};
+
+// FSRS-4.5 memory model with pass/fail grades: stability grows on recall in
+// proportion to how hard the card is and how much it had been forgotten,
+// and the interval is the time for recall probability to fall to
+// desiredRetention.
+class FsrsScheduler : public SchedulerEngine {
+public:
+    using Weights = std::array<double, 17>;
+
+    static const Weights kDefaultWeights;
+
+    explicit FsrsScheduler(double desiredRetention = 0.9,
+                           const Weights& weights = kDefaultWeights);
+
+    std::string name() const override { return "fsrs"; }
+    void review(CardState& card, bool correct, int64_t now) const override;
+    void reschedule(CardBatch& batch) const override;
+
+private:
+    double retrievability(double elapsedDays, double stability) const;
+    double intervalDays(double stability) const;
+
+    double desiredRetention;
+    Weights w;
+    double intervalFactor;   // Interval per day of stability at desiredRetention
+};
+
+#endif // SCHEDULER_H
@@ -1,16 +1,21 @@
 // base_repository.cpp
-// This file is a placeholder for the base repository implementation.
+// Shared database plumbing for repositories: connection access and the
+// prepared statement cache.
 
 #include "base_repository.h"
 #include <QSqlError>
 #include <QString>
+#include <QDebug>
 
-// The implementation of BaseRepository is mostly in the header file
-// since it's primarily a base class with protected constructor and database management.
+namespace {
+    struct TransactionState {
+        int depth = 0;
+        bool rollbackOnly = false;
+    };
 
-// However, we can add some utility functions that might be useful for derived classes
+    // Connections are per thread, and so is transaction nesting.
+    thread_local TransactionState transactionState;
 
-namespace {
     [[maybe_unused]] void checkDatabaseError(const QSqlDatabase& db) {
         if (db.lastError().isValid()) {
             throw std::runtime_error(
@@ -19,3 +24,114 @@ namespace {
         }
     }
 }
+
+bool BaseRepository::beginTransaction() {
+    if (transactionState.depth++ > 0) {
+        return true;
+    }
+    transactionState.rollbackOnly = false;
+    return ConnectionPool::instance().connection(Access::Write).transaction();
+}
+
+bool BaseRepository::commitTransaction() {
+    if (--transactionState.depth > 0) {
+        return !transactionState.rollbackOnly;
+    }
+    QSqlDatabase database = ConnectionPool::instance().connection(Access::Write);
+    if (transactionState.rollbackOnly || !database.commit()) {
+        database.rollback();
+        return false;
+    }
+    return true;
+}
+
+void BaseRepository::rollbackTransaction() {
+    if (--transactionState.depth > 0) {
+        transactionState.rollbackOnly = true;
+        return;
+    }
+    ConnectionPool::instance().connection(Access::Write).rollback();
+}
+
+BaseRepository::TransactionGuard::TransactionGuard()
+    : writeLock(ConnectionPool::instance().lockWriter()), finished(false) {
+    beginTransaction();
+}
+
+BaseRepository::TransactionGuard::~TransactionGuard() {
+    if (!finished) {
+        rollbackTransaction();
+    }
+}
+
+bool BaseRepository::TransactionGuard::commit() {
+    finished = true;
+    return commitTransaction();
+}
+
+BaseRepository::CachedQuery::CachedQuery(QSqlQuery* query, bool* inUse)
+    : query(query), inUse(inUse) {
+    *inUse = true;
+}
+
+BaseRepository::CachedQuery::CachedQuery(std::unique_ptr<QSqlQuery> owned)
+    : owned(std::move(owned)), query(this->owned.get()), inUse(nullptr) {}
+
+BaseRepository::CachedQuery::~CachedQuery() {
+    // Reset the statement so it does not keep a read transaction open
+    // while it sits in the cache.
+    query->finish();
+    if (inUse) {
+        *inUse = false;
+    }
+}
+
+BaseRepository::CachedQuery BaseRepository::cachedQuery(const QString& sql, Access access) {
+    QSqlDatabase connection = db(access);
+    std::lock_guard<std::mutex> lock(cacheMutex);
+
+    auto key = std::make_pair(connection.connectionName(), sql);
+    auto it = statementCache.find(key);
+    if (it != statementCache.end()) {
+        if (!it->second.inUse) {
+            ++cacheHits;
+            return CachedQuery(&it->second.query, &it->second.inUse);
+        }
+    } else {
+        QSqlQuery query(connection);
+        query.setForwardOnly(true);
+        if (query.prepare(sql)) {
+            ++cacheMisses;
+            it = statementCache.emplace(key, CachedStatement{query, false}).first;
+            return CachedQuery(&it->second.query, &it->second.inUse);
+        }
+        qDebug() << "Statement not cached:" << query.lastError().text() << "SQL:" << sql;
+    }
+
+    // Nested borrow of a busy statement, or a statement that failed to
+    // prepare: hand out a private copy so the caller sees the usual errors.
+    ++cacheMisses;
+    auto query = std::make_unique<QSqlQuery>(connection);
+    query->setForwardOnly(true);
+    query->prepare(sql);
+    return CachedQuery(std::move(query));
+}
+
+void BaseRepository::dropStatements(const QString& connectionName) {
+    // Runs on the connection's own thread as it finishes, so nothing can
+    // still be borrowing these statements
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    auto it = statementCache.lower_bound(std::make_pair(connectionName, QString()));
+    while (it != statementCache.end() && it->first.first == connectionName) {
+        it = statementCache.erase(it);
+    }
+}
+
+BaseRepository::StatementCacheStats BaseRepository::getStatementCacheStats() const {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    StatementCacheStats stats;
+    stats.hits = cacheHits;
+    stats.misses = cacheMisses;
+    stats.size = statementCache.size();
+    return stats;
+}
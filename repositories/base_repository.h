@@ -1,26 +1,126 @@
 #ifndef BASE_REPOSITORY_H
 #define BASE_REPOSITORY_H
 
+#include "connection_pool.h"
 #include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QString>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <stdexcept>
+#include <utility>
 
 class BaseRepository {
-protected:
-    QSqlDatabase& db;
+public:
+    struct StatementCacheStats {
+        quint64 hits = 0;
+        quint64 misses = 0;
+        size_t size = 0;
+    };
 
-    BaseRepository() : db(getDatabase()) {}
+protected:
+    using Access = ConnectionPool::Access;
 
-    static QSqlDatabase& getDatabase() {
-        static QSqlDatabase database = QSqlDatabase::database();
-        if (!database.isValid()) {
+    BaseRepository() {
+        if (!ConnectionPool::instance().isInitialized()) {
             throw std::runtime_error("Database connection not initialized");
         }
-        return database;
+        closeListener = ConnectionPool::instance().addCloseListener(
+            [this](const QString& connectionName) { dropStatements(connectionName); });
     }
 
+    // The calling thread's connection. Repositories are shared between the
+    // GUI thread and worker threads, so never hold on to the handle beyond
+    // the current call.
+    QSqlDatabase db(Access access = Access::Read) const {
+        return ConnectionPool::instance().connection(access);
+    }
+
+    // Write paths hold this for the whole transaction.
+    std::unique_lock<std::recursive_mutex> lockWriter() const {
+        return ConnectionPool::instance().lockWriter();
+    }
+
+    // Transactions on the calling thread's writer connection. They nest:
+    // only the outermost begin/commit reach SQLite, and a rollback at any
+    // depth makes the outermost commit roll back instead. Hold the writer
+    // lock around the whole transaction.
+    static bool beginTransaction();
+    static bool commitTransaction();
+    static void rollbackTransaction();
+
+    // A prepared statement borrowed from the repository's cache. Rebind its
+    // values and exec() it as usual; its result set is released and the
+    // statement handed back to the cache when the handle goes out of scope.
+    class CachedQuery {
+    public:
+        CachedQuery(const CachedQuery&) = delete;
+        CachedQuery& operator=(const CachedQuery&) = delete;
+        ~CachedQuery();
+
+        QSqlQuery& operator*() { return *query; }
+        QSqlQuery* operator->() { return query; }
+
+    private:
+        friend class BaseRepository;
+        CachedQuery(QSqlQuery* query, bool* inUse);
+        explicit CachedQuery(std::unique_ptr<QSqlQuery> owned);
+
+        std::unique_ptr<QSqlQuery> owned;
+        QSqlQuery* query;
+        bool* inUse;
+    };
+
+    // Returns the cached prepared statement for sql on this thread's
+    // connection, preparing it on first use. Only pass SQL from a fixed set
+    // of statements: entries are only evicted when their connection closes. A statement already borrowed
+    // further up the stack is not shared; the caller gets a fresh, uncached
+    // one instead.
+    CachedQuery cachedQuery(const QString& sql, Access access = Access::Read);
+
 public:
-    virtual ~BaseRepository() = default;
+    virtual ~BaseRepository() {
+        ConnectionPool::instance().removeCloseListener(closeListener);
+    }
+    BaseRepository(const BaseRepository&) = delete;
+    BaseRepository& operator=(const BaseRepository&) = delete;
+
+    // Groups writes from several repositories into one transaction on the
+    // calling thread. Rolls back unless commit() is called.
+    class TransactionGuard {
+    public:
+        TransactionGuard();
+        TransactionGuard(const TransactionGuard&) = delete;
+        TransactionGuard& operator=(const TransactionGuard&) = delete;
+        ~TransactionGuard();
+
+        bool commit();
+
+    private:
+        std::unique_lock<std::recursive_mutex> writeLock;
+        bool finished;
+    };
+
+    StatementCacheStats getStatementCacheStats() const;
+
+private:
+    struct CachedStatement {
+        QSqlQuery query;
+        bool inUse = false;
+    };
+
+    // Keyed by (connection name, SQL), so each thread only ever borrows
+    // statements prepared on its own connection. std::map keeps entries in
+    // place, so borrowed handles stay valid while new statements are added.
+    std::map<std::pair<QString, QString>, CachedStatement> statementCache;
+    mutable std::mutex cacheMutex;
+    int closeListener = -1;
+
+    // Releases the statements prepared on a connection that is closing
+    void dropStatements(const QString& connectionName);
+    quint64 cacheHits = 0;
+    quint64 cacheMisses = 0;
 };
 
 #endif // BASE_REPOSITORY_H
@@ -0,0 +1,136 @@
+#include "connection_pool.h"
+#include <QSqlError>
+#include <QThread>
+#include <algorithm>
+#include <stdexcept>
+
+// Per-thread connection names; closes the connections when the owning
+// thread finishes.
+struct ConnectionPool::ThreadConnections {
+    QString reader;
+    QString writer;
+
+    ~ThreadConnections() {
+        // Cached statements must go before their connection does
+        auto& pool = ConnectionPool::instance();
+        if (!reader.isEmpty()) {
+            pool.notifyClosing(reader);
+            QSqlDatabase::removeDatabase(reader);
+            --pool.openReaders;
+        }
+        if (!writer.isEmpty()) {
+            pool.notifyClosing(writer);
+            QSqlDatabase::removeDatabase(writer);
+        }
+    }
+};
+
+ConnectionPool& ConnectionPool::instance() {
+    static ConnectionPool pool;
+    return pool;
+}
+
+void ConnectionPool::initialize(const QSqlDatabase& primary, int readerCount,
+                                const StorageProfile& profile) {
+    if (!primary.isValid() || !primary.isOpen()) {
+        throw std::runtime_error("Database connection not initialized");
+    }
+
+    databaseName = primary.databaseName();
+    primaryName = primary.connectionName();
+    ownerThread = QThread::currentThreadId();
+    this->readerCount = std::max(1, readerCount);
+    this->profile = profile;
+
+    // Worker threads hold their reader connection for the life of the pool.
+    workers = std::make_unique<QThreadPool>();
+    workers->setMaxThreadCount(this->readerCount);
+    workers->setExpiryTimeout(-1);
+
+    initialized = true;
+}
+
+void ConnectionPool::shutdown() {
+    // Deleting the thread pool joins its threads, which closes their
+    // connections through ThreadConnections.
+    workers.reset();
+    initialized = false;
+}
+
+QSqlDatabase ConnectionPool::connection(Access access) {
+    if (!initialized) {
+        throw std::runtime_error("Database connection not initialized");
+    }
+
+    if (QThread::currentThreadId() == ownerThread) {
+        return QSqlDatabase::database(primaryName, false);
+    }
+
+    if (!threadConnections.hasLocalData()) {
+        threadConnections.setLocalData(new ThreadConnections);
+    }
+    auto* local = threadConnections.localData();
+    QString& name = access == Access::Read ? local->reader : local->writer;
+
+    if (name.isEmpty()) {
+        std::lock_guard<std::mutex> lock(openMutex);
+        if (access == Access::Read && openReaders >= readerCount) {
+            throw std::runtime_error("No reader connection available");
+        }
+        QString connectionName = QString("%1-%2-%3")
+            .arg(primaryName)
+            .arg(access == Access::Read ? "reader" : "writer")
+            .arg(nextConnectionId++);
+        open(connectionName, access);
+        if (access == Access::Read) {
+            ++openReaders;
+        }
+        name = connectionName;
+    }
+
+    return QSqlDatabase::database(name, false);
+}
+
+QSqlDatabase ConnectionPool::open(const QString& name, Access access) {
+    QSqlDatabase db = QSqlDatabase::cloneDatabase(primaryName, name);
+    db.setDatabaseName(databaseName);
+    if (access == Access::Read) {
+        db.setConnectOptions("QSQLITE_OPEN_READONLY");
+    }
+
+    if (!db.open()) {
+        QString error = db.lastError().text();
+        db = QSqlDatabase();
+        QSqlDatabase::removeDatabase(name);
+        throw std::runtime_error(
+            QString("Could not open database connection %1: %2")
+                .arg(name, error).toStdString());
+    }
+
+    // Connection-level PRAGMAs do not carry over from the primary connection.
+    profile.apply(db);
+    return db;
+}
+
+int ConnectionPool::addCloseListener(CloseListener listener) {
+    std::lock_guard<std::mutex> lock(listenerMutex);
+    int id = nextListenerId++;
+    closeListeners.emplace(id, std::move(listener));
+    return id;
+}
+
+void ConnectionPool::removeCloseListener(int id) {
+    std::lock_guard<std::mutex> lock(listenerMutex);
+    closeListeners.erase(id);
+}
+
+void ConnectionPool::notifyClosing(const QString& name) {
+    std::lock_guard<std::mutex> lock(listenerMutex);
+    for (const auto& [id, listener] : closeListeners) {
+        listener(name);
+    }
+}
+
+std::unique_lock<std::recursive_mutex> ConnectionPool::lockWriter() {
+    return std::unique_lock<std::recursive_mutex>(writerMutex);
+}
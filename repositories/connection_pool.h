@@ -0,0 +1,90 @@
+#ifndef CONNECTION_POOL_H
+#define CONNECTION_POOL_H
+
+#include "storage_profile.h"
+#include <QSqlDatabase>
+#include <QString>
+#include <QThreadPool>
+#include <QThreadStorage>
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+
+// Hands out SQLite connections per thread. QSqlDatabase handles may only be
+// used on the thread that opened them, so every worker thread gets its own
+// connection to the same database file, opened lazily on first use and
+// closed when the thread finishes.
+//
+// The thread that initialized the pool (the GUI thread) keeps the primary
+// connection for both reads and writes. Other threads read through up to
+// readerCount read-only connections, and all writers, wherever they run,
+// take turns through a single writer lock.
+class ConnectionPool {
+public:
+    enum class Access {
+        Read,
+        Write
+    };
+
+    static ConnectionPool& instance();
+
+    ConnectionPool(const ConnectionPool&) = delete;
+    ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+    void initialize(const QSqlDatabase& primary, int readerCount,
+                    const StorageProfile& profile = StorageProfile::balanced());
+    bool isInitialized() const { return initialized; }
+
+    // Stops the worker threads and closes their connections. Call before
+    // the QApplication goes away.
+    void shutdown();
+
+    // Returns this thread's connection for the requested access.
+    QSqlDatabase connection(Access access = Access::Read);
+
+    // Serializes writers across connections. Hold the lock for the whole
+    // write transaction; it is recursive so repository writes can nest.
+    std::unique_lock<std::recursive_mutex> lockWriter();
+
+    // Called with a worker connection's name just before the connection is
+    // closed, on the thread that owned it, so statements prepared on it can
+    // be released first. removeCloseListener() returns once no call to the
+    // listener is running.
+    using CloseListener = std::function<void(const QString& connectionName)>;
+    int addCloseListener(CloseListener listener);
+    void removeCloseListener(int id);
+
+    // Thread pool sized to the reader connections, for off-GUI-thread reads.
+    QThreadPool* readerThreads() { return workers.get(); }
+    int getReaderCount() const { return readerCount; }
+    const StorageProfile& getStorageProfile() const { return profile; }
+
+private:
+    struct ThreadConnections;
+
+    ConnectionPool() = default;
+
+    QSqlDatabase open(const QString& name, Access access);
+    void notifyClosing(const QString& name);
+
+    bool initialized = false;
+    QString databaseName;
+    QString primaryName;
+    Qt::HANDLE ownerThread = nullptr;
+    int readerCount = 0;
+    StorageProfile profile = StorageProfile::balanced();
+
+    std::mutex openMutex;
+    std::atomic<int> openReaders{0};
+    std::atomic<int> nextConnectionId{0};
+    std::recursive_mutex writerMutex;
+    QThreadStorage<ThreadConnections*> threadConnections;
+    std::mutex listenerMutex;
+    std::map<int, CloseListener> closeListeners;
+    int nextListenerId = 0;
+    std::unique_ptr<QThreadPool> workers;
+};
+
+#endif // CONNECTION_POOL_H
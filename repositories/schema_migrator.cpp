@@ -0,0 +1,453 @@
+#include "schema_migrator.h"
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QDebug>
+#include <stdexcept>
+
+SchemaMigrator::SchemaMigrator(const QSqlDatabase& db) : db(db) {}
+
+const std::vector<SchemaMigrator::Migration>& SchemaMigrator::migrations() {
+    static const std::vector<Migration> steps = {
+        {1, "Base tables", {
+            // IF NOT EXISTS: databases created before migrations existed
+            // already have the first four tables.
+            "CREATE TABLE IF NOT EXISTS users ("
+            "username TEXT PRIMARY KEY,"
+            "password TEXT,"
+            "total_score INTEGER DEFAULT 0,"
+            "days_streak INTEGER DEFAULT 0,"
+            "total_words_learned INTEGER DEFAULT 0,"
+            "last_checkin_date TEXT,"
+            "created_at TEXT"
+            ")",
+
+            "CREATE TABLE IF NOT EXISTS words ("
+            "english TEXT PRIMARY KEY,"
+            "part_of_speech TEXT,"
+            "chinese TEXT,"
+            "frequency INTEGER DEFAULT 0,"
+            "correct_count INTEGER DEFAULT 0,"
+            "total_attempts INTEGER DEFAULT 0"
+            ")",
+
+            "CREATE TABLE IF NOT EXISTS word_definitions ("
+            "english TEXT,"
+            "definition_type TEXT,"
+            "content TEXT,"
+            "FOREIGN KEY(english) REFERENCES words(english) ON DELETE CASCADE"
+            ")",
+
+            "CREATE TABLE IF NOT EXISTS word_categories ("
+            "english TEXT,"
+            "category TEXT,"
+            "FOREIGN KEY(english) REFERENCES words(english) ON DELETE CASCADE"
+            ")",
+
+            // Per-user review state, read by findDueForReview
+            "CREATE TABLE IF NOT EXISTS learning_records ("
+            "username TEXT NOT NULL,"
+            "word TEXT NOT NULL,"
+            "mastery_level INTEGER DEFAULT 1,"
+            "last_review_date TEXT,"
+            "PRIMARY KEY (username, word)"
+            ")",
+
+            // One row per answer; word_id is the rowid of the word
+            "CREATE TABLE IF NOT EXISTS attempts ("
+            "id INTEGER PRIMARY KEY,"
+            "username TEXT NOT NULL,"
+            "word_id INTEGER NOT NULL,"
+            "correct INTEGER NOT NULL,"
+            "attempt_date TEXT NOT NULL,"
+            "review_time_seconds INTEGER DEFAULT 0"
+            ")"
+        }},
+        {2, "Lookup indexes", {
+            // findByEnglish and batched hydration
+            "CREATE INDEX IF NOT EXISTS idx_word_definitions_english "
+            "ON word_definitions(english)",
+            "CREATE INDEX IF NOT EXISTS idx_word_categories_english "
+            "ON word_categories(english, category)",
+            // findByCategory and getWordCountByCategory
+            "CREATE INDEX IF NOT EXISTS idx_word_categories_category "
+            "ON word_categories(category, english)",
+            // getMostFrequentWords
+            "CREATE INDEX IF NOT EXISTS idx_words_frequency "
+            "ON words(frequency)",
+            // getDailyStats and getTotalReviewTime
+            "CREATE INDEX IF NOT EXISTS idx_attempts_user_date "
+            "ON attempts(username, attempt_date, correct, word_id, review_time_seconds)",
+            // getWordStats and getMostReviewedWords
+            "CREATE INDEX IF NOT EXISTS idx_attempts_word "
+            "ON attempts(word_id, username, correct)",
+            // learning_records(username, word) is covered by its primary key
+        }},
+        {3, "Materialized review due dates", {
+            "ALTER TABLE learning_records ADD COLUMN next_review_at INTEGER",
+            // The 1/3/7/14 day intervals ReviewSession used then; records
+            // that were never reviewed are due right away
+            "UPDATE learning_records SET next_review_at = COALESCE("
+            "CAST(strftime('%s', last_review_date) AS INTEGER) + 86400 * "
+            "CASE mastery_level WHEN 1 THEN 1 WHEN 2 THEN 3 WHEN 3 THEN 7 ELSE 14 END, 0)",
+            // findDueForReview: range scan of one user's due cards
+            "CREATE INDEX IF NOT EXISTS idx_learning_records_due "
+            "ON learning_records(username, next_review_at, word)",
+        }},
+        {4, "Full-text word search", {
+            // One document per word, keyed by the word's rowid. Prefix
+            // indexes keep short search-as-you-type prefixes cheap.
+            "CREATE VIRTUAL TABLE IF NOT EXISTS word_search USING fts5("
+            "english, chinese, definitions, "
+            "tokenize = 'unicode61 remove_diacritics 2', prefix = '1 2 3')",
+            // Matches on the headword outrank matches in its definitions
+            "INSERT INTO word_search(word_search, rank) "
+            "VALUES('rank', 'bm25(10.0, 5.0, 1.0)')",
+            "INSERT INTO word_search(rowid, english, chinese, definitions) "
+            "SELECT rowid, english, chinese, "
+            "(SELECT group_concat(content, ' ') FROM word_definitions d "
+            "WHERE d.english = w.english) FROM words w",
+
+            // Keep the index in step with words and word_definitions.
+            // Stats updates do not touch indexed columns and skip the triggers.
+            "CREATE TRIGGER IF NOT EXISTS word_search_words_insert "
+            "AFTER INSERT ON words BEGIN "
+            "INSERT INTO word_search(rowid, english, chinese, definitions) "
+            "VALUES (NEW.rowid, NEW.english, NEW.chinese, "
+            "(SELECT group_concat(content, ' ') FROM word_definitions "
+            "WHERE english = NEW.english)); "
+            "END",
+            "CREATE TRIGGER IF NOT EXISTS word_search_words_update "
+            "AFTER UPDATE OF english, chinese ON words BEGIN "
+            "DELETE FROM word_search WHERE rowid = OLD.rowid; "
+            "INSERT INTO word_search(rowid, english, chinese, definitions) "
+            "VALUES (NEW.rowid, NEW.english, NEW.chinese, "
+            "(SELECT group_concat(content, ' ') FROM word_definitions "
+            "WHERE english = NEW.english)); "
+            "END",
+            "CREATE TRIGGER IF NOT EXISTS word_search_words_delete "
+            "AFTER DELETE ON words BEGIN "
+            "DELETE FROM word_search WHERE rowid = OLD.rowid; "
+            "END",
+            "CREATE TRIGGER IF NOT EXISTS word_search_definitions_insert "
+            "AFTER INSERT ON word_definitions BEGIN "
+            "UPDATE word_search SET definitions = "
+            "(SELECT group_concat(content, ' ') FROM word_definitions "
+            "WHERE english = NEW.english) "
+            "WHERE rowid = (SELECT rowid FROM words WHERE english = NEW.english); "
+            "END",
+            "CREATE TRIGGER IF NOT EXISTS word_search_definitions_update "
+            "AFTER UPDATE OF english, content ON word_definitions BEGIN "
+            "UPDATE word_search SET definitions = "
+            "(SELECT group_concat(content, ' ') FROM word_definitions "
+            "WHERE english = OLD.english) "
+            "WHERE rowid = (SELECT rowid FROM words WHERE english = OLD.english); "
+            "UPDATE word_search SET definitions = "
+            "(SELECT group_concat(content, ' ') FROM word_definitions "
+            "WHERE english = NEW.english) "
+            "WHERE rowid = (SELECT rowid FROM words WHERE english = NEW.english); "
+            "END",
+            "CREATE TRIGGER IF NOT EXISTS word_search_definitions_delete "
+            "AFTER DELETE ON word_definitions BEGIN "
+            "UPDATE word_search SET definitions = "
+            "(SELECT group_concat(content, ' ') FROM word_definitions "
+            "WHERE english = OLD.english) "
+            "WHERE rowid = (SELECT rowid FROM words WHERE english = OLD.english); "
+            "END",
+        }},
+        {5, "Daily review rollups", {
+            // One row per user and local day, updated by recordResults, so
+            // getDailyStats reads a range instead of grouping attempts.
+            // Backfilled days are local, like the ones recordResults writes.
+            "CREATE TABLE IF NOT EXISTS daily_rollups ("
+            "username TEXT NOT NULL,"
+            "day TEXT NOT NULL,"
+            "words_learned INTEGER NOT NULL DEFAULT 0,"
+            "words_reviewed INTEGER NOT NULL DEFAULT 0,"
+            "correct_count INTEGER NOT NULL DEFAULT 0,"
+            "PRIMARY KEY (username, day)"
+            ") WITHOUT ROWID",
+            "INSERT OR IGNORE INTO daily_rollups "
+            "(username, day, words_learned, words_reviewed, correct_count) "
+            "SELECT username, DATE(attempt_date, 'localtime'), COUNT(DISTINCT word_id), "
+            "COUNT(*), SUM(CASE WHEN correct THEN 1 ELSE 0 END) FROM attempts "
+            "WHERE DATE(attempt_date, 'localtime') IS NOT NULL "
+            "GROUP BY username, DATE(attempt_date, 'localtime')",
+        }},
+        {6, "Category counts", {
+            // Word count per category, kept exact by the triggers below, so
+            // getWordCountByCategory does not group all of word_categories
+            "CREATE TABLE IF NOT EXISTS category_counts ("
+            "category TEXT PRIMARY KEY,"
+            "word_count INTEGER NOT NULL"
+            ") WITHOUT ROWID",
+            "INSERT OR REPLACE INTO category_counts (category, word_count) "
+            "SELECT category, COUNT(*) FROM word_categories "
+            "WHERE category IS NOT NULL GROUP BY category",
+
+            "CREATE TRIGGER IF NOT EXISTS category_counts_insert "
+            "AFTER INSERT ON word_categories WHEN NEW.category IS NOT NULL BEGIN "
+            "INSERT INTO category_counts (category, word_count) VALUES (NEW.category, 1) "
+            "ON CONFLICT(category) DO UPDATE SET word_count = word_count + 1; "
+            "END",
+            "CREATE TRIGGER IF NOT EXISTS category_counts_delete "
+            "AFTER DELETE ON word_categories WHEN OLD.category IS NOT NULL BEGIN "
+            "UPDATE category_counts SET word_count = word_count - 1 "
+            "WHERE category = OLD.category; "
+            "DELETE FROM category_counts WHERE category = OLD.category AND word_count <= 0; "
+            "END",
+            "CREATE TRIGGER IF NOT EXISTS category_counts_update "
+            "AFTER UPDATE OF category ON word_categories BEGIN "
+            "UPDATE category_counts SET word_count = word_count - 1 "
+            "WHERE category = OLD.category; "
+            "DELETE FROM category_counts WHERE category = OLD.category AND word_count <= 0; "
+            "INSERT INTO category_counts (category, word_count) "
+            "SELECT NEW.category, 1 WHERE NEW.category IS NOT NULL "
+            "ON CONFLICT(category) DO UPDATE SET word_count = word_count + 1; "
+            "END",
+        }},
+        {7, "Stable word ids and append-only attempts log", {
+            // Give words an explicit INTEGER PRIMARY KEY, keeping the current
+            // rowids, so attempts and word_search can rely on ids that VACUUM
+            // will not renumber. AUTOINCREMENT keeps a deleted word's id from
+            // being reused while the log still refers to it. foreign_keys is
+            // off, so dropping the old table leaves definitions alone.
+            "DROP TRIGGER IF EXISTS word_search_definitions_insert",
+            "DROP TRIGGER IF EXISTS word_search_definitions_update",
+            "DROP TRIGGER IF EXISTS word_search_definitions_delete",
+            "CREATE TABLE words_new ("
+            "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+            "english TEXT NOT NULL UNIQUE,"
+            "part_of_speech TEXT,"
+            "chinese TEXT,"
+            "frequency INTEGER DEFAULT 0,"
+            "correct_count INTEGER DEFAULT 0,"
+            "total_attempts INTEGER DEFAULT 0"
+            ")",
+            "INSERT INTO words_new "
+            "(id, english, part_of_speech, chinese, frequency, correct_count, total_attempts) "
+            "SELECT rowid, english, part_of_speech, chinese, frequency, correct_count, "
+            "total_attempts FROM words",
+            "DROP TABLE words",
+            "ALTER TABLE words_new RENAME TO words",
+            "CREATE INDEX IF NOT EXISTS idx_words_frequency ON words(frequency)",
+
+            "CREATE TRIGGER IF NOT EXISTS word_search_words_insert "
+            "AFTER INSERT ON words BEGIN "
+            "INSERT INTO word_search(rowid, english, chinese, definitions) "
+            "VALUES (NEW.id, NEW.english, NEW.chinese, "
+            "(SELECT group_concat(content, ' ') FROM word_definitions "
+            "WHERE english = NEW.english)); "
+            "END",
+            "CREATE TRIGGER IF NOT EXISTS word_search_words_update "
+            "AFTER UPDATE OF english, chinese ON words BEGIN "
+            "DELETE FROM word_search WHERE rowid = OLD.id; "
+            "INSERT INTO word_search(rowid, english, chinese, definitions) "
+            "VALUES (NEW.id, NEW.english, NEW.chinese, "
+            "(SELECT group_concat(content, ' ') FROM word_definitions "
+            "WHERE english = NEW.english)); "
+            "END",
+            "CREATE TRIGGER IF NOT EXISTS word_search_words_delete "
+            "AFTER DELETE ON words BEGIN "
+            "DELETE FROM word_search WHERE rowid = OLD.id; "
+            "END",
+            "CREATE TRIGGER IF NOT EXISTS word_search_definitions_insert "
+            "AFTER INSERT ON word_definitions BEGIN "
+            "UPDATE word_search SET definitions = "
+            "(SELECT group_concat(content, ' ') FROM word_definitions "
+            "WHERE english = NEW.english) "
+            "WHERE rowid = (SELECT id FROM words WHERE english = NEW.english); "
+            "END",
+            "CREATE TRIGGER IF NOT EXISTS word_search_definitions_update "
+            "AFTER UPDATE OF english, content ON word_definitions BEGIN "
+            "UPDATE word_search SET definitions = "
+            "(SELECT group_concat(content, ' ') FROM word_definitions "
+            "WHERE english = OLD.english) "
+            "WHERE rowid = (SELECT id FROM words WHERE english = OLD.english); "
+            "UPDATE word_search SET definitions = "
+            "(SELECT group_concat(content, ' ') FROM word_definitions "
+            "WHERE english = NEW.english) "
+            "WHERE rowid = (SELECT id FROM words WHERE english = NEW.english); "
+            "END",
+            "CREATE TRIGGER IF NOT EXISTS word_search_definitions_delete "
+            "AFTER DELETE ON word_definitions BEGIN "
+            "UPDATE word_search SET definitions = "
+            "(SELECT group_concat(content, ' ') FROM word_definitions "
+            "WHERE english = OLD.english) "
+            "WHERE rowid = (SELECT id FROM words WHERE english = OLD.english); "
+            "END",
+
+            // One row per answer, clustered by (username, attempted_at) so a
+            // user's time range is a contiguous scan. Times are epoch
+            // seconds; the same word answered twice in one second by one
+            // user is kept once.
+            "CREATE TABLE attempts_new ("
+            "username TEXT NOT NULL,"
+            "attempted_at INTEGER NOT NULL,"
+            "word_id INTEGER NOT NULL,"
+            "correct INTEGER NOT NULL,"
+            "response_ms INTEGER NOT NULL DEFAULT 0,"
+            "PRIMARY KEY (username, attempted_at, word_id)"
+            ") WITHOUT ROWID",
+            "INSERT OR IGNORE INTO attempts_new "
+            "(username, attempted_at, word_id, correct, response_ms) "
+            "SELECT username, CAST(strftime('%s', attempt_date) AS INTEGER), word_id, "
+            "correct, COALESCE(review_time_seconds, 0) * 1000 FROM attempts "
+            "WHERE strftime('%s', attempt_date) IS NOT NULL",
+            "DROP TABLE attempts",
+            "ALTER TABLE attempts_new RENAME TO attempts",
+            // getWordStats and getMostReviewedWords
+            "CREATE INDEX IF NOT EXISTS idx_attempts_word "
+            "ON attempts(word_id, username, correct)",
+        }},
+        {8, "Per-card scheduler state", {
+            // See CardState: stability in days, difficulty on a 1-10 scale,
+            // last_review_at in epoch seconds
+            "ALTER TABLE learning_records ADD COLUMN stability REAL NOT NULL DEFAULT 0",
+            "ALTER TABLE learning_records ADD COLUMN difficulty REAL NOT NULL DEFAULT 0",
+            "ALTER TABLE learning_records ADD COLUMN reps INTEGER NOT NULL DEFAULT 0",
+            "ALTER TABLE learning_records ADD COLUMN lapses INTEGER NOT NULL DEFAULT 0",
+            "ALTER TABLE learning_records ADD COLUMN last_review_at INTEGER NOT NULL DEFAULT 0",
+            // Existing cards keep their current interval as stability and
+            // start from a middling difficulty
+            "UPDATE learning_records SET "
+            "last_review_at = COALESCE(CAST(strftime('%s', last_review_date) AS INTEGER), 0), "
+            "stability = CASE mastery_level WHEN 1 THEN 1 WHEN 2 THEN 3 WHEN 3 THEN 7 ELSE 14 END, "
+            "difficulty = 5, "
+            "reps = MAX(mastery_level - 1, 0)",
+        }},
+        {9, "Leaderboard score index", {
+            // Users in leaderboard order, so getTopUsers reads the first
+            // rows instead of sorting the table and a cold start can load
+            // the Leaderboard in order
+            "CREATE INDEX IF NOT EXISTS idx_users_score "
+            "ON users(total_score DESC, username)",
+        }},
+        {10, "Attempts keyed by sequence", {
+            // seq numbers a user's answers within one second, so answers
+            // logged in the same second, even to the same word, are all
+            // kept. Existing rows are numbered in word order.
+            "CREATE TABLE attempts_new ("
+            "username TEXT NOT NULL,"
+            "attempted_at INTEGER NOT NULL,"
+            "seq INTEGER NOT NULL,"
+            "word_id INTEGER NOT NULL,"
+            "correct INTEGER NOT NULL,"
+            "response_ms INTEGER NOT NULL DEFAULT 0,"
+            "PRIMARY KEY (username, attempted_at, seq)"
+            ") WITHOUT ROWID",
+            "INSERT INTO attempts_new "
+            "(username, attempted_at, seq, word_id, correct, response_ms) "
+            "SELECT username, attempted_at, "
+            "(SELECT COUNT(*) FROM attempts b WHERE b.username = a.username "
+            "AND b.attempted_at = a.attempted_at AND b.word_id < a.word_id), "
+            "word_id, correct, response_ms FROM attempts a",
+            "DROP TABLE attempts",
+            "ALTER TABLE attempts_new RENAME TO attempts",
+            "CREATE INDEX IF NOT EXISTS idx_attempts_word "
+            "ON attempts(word_id, username, correct)",
+        }},
+        {11, "Scheduler per user", {
+            // The SchedulerEngine that set the user's due dates, so a change
+            // of WORD_SYSTEM_SCHEDULER reschedules their cards at next login.
+            // Existing due dates follow SM-2 intervals.
+            "ALTER TABLE users ADD COLUMN scheduler TEXT NOT NULL DEFAULT 'sm2'",
+        }},
+        {12, "Han characters searchable one by one", {
+            // unicode61 keeps a run of Han characters as one token, so 书
+            // never matched inside 图书馆. chinese_terms is chinese with a
+            // space around each Han character (see splitHan in
+            // WordRepository, which keeps it up to date) and is what
+            // word_search indexes.
+            "ALTER TABLE words ADD COLUMN chinese_terms TEXT",
+            "UPDATE words SET chinese_terms = ("
+            "WITH RECURSIVE chars(i, terms) AS ("
+            "SELECT 1, '' "
+            "UNION ALL "
+            "SELECT i + 1, terms || CASE "
+            "WHEN unicode(substr(words.chinese, i, 1)) BETWEEN 0x3400 AND 0x4DBF "
+            "OR unicode(substr(words.chinese, i, 1)) BETWEEN 0x4E00 AND 0x9FFF "
+            "OR unicode(substr(words.chinese, i, 1)) BETWEEN 0xF900 AND 0xFAFF "
+            "OR unicode(substr(words.chinese, i, 1)) BETWEEN 0x20000 AND 0x3134F "
+            "THEN ' ' || substr(words.chinese, i, 1) || ' ' "
+            "ELSE substr(words.chinese, i, 1) END "
+            "FROM chars WHERE i <= length(words.chinese)) "
+            "SELECT terms FROM chars ORDER BY i DESC LIMIT 1) "
+            "WHERE chinese IS NOT NULL",
+            "UPDATE word_search SET chinese = "
+            "(SELECT chinese_terms FROM words WHERE id = word_search.rowid)",
+
+            "DROP TRIGGER IF EXISTS word_search_words_insert",
+            "DROP TRIGGER IF EXISTS word_search_words_update",
+            "CREATE TRIGGER IF NOT EXISTS word_search_words_insert "
+            "AFTER INSERT ON words BEGIN "
+            "INSERT INTO word_search(rowid, english, chinese, definitions) "
+            "VALUES (NEW.id, NEW.english, NEW.chinese_terms, "
+            "(SELECT group_concat(content, ' ') FROM word_definitions "
+            "WHERE english = NEW.english)); "
+            "END",
+            "CREATE TRIGGER IF NOT EXISTS word_search_words_update "
+            "AFTER UPDATE OF english, chinese_terms ON words BEGIN "
+            "DELETE FROM word_search WHERE rowid = OLD.id; "
+            "INSERT INTO word_search(rowid, english, chinese, definitions) "
+            "VALUES (NEW.id, NEW.english, NEW.chinese_terms, "
+            "(SELECT group_concat(content, ' ') FROM word_definitions "
+            "WHERE english = NEW.english)); "
+            "END",
+        }},
+    };
+    return steps;
+}
+
+int SchemaMigrator::latestVersion() {
+    return migrations().empty() ? 0 : migrations().back().version;
+}
+
+int SchemaMigrator::currentVersion() const {
+    QSqlQuery query(db);
+    if (query.exec("PRAGMA user_version") && query.next()) {
+        return query.value(0).toInt();
+    }
+    return 0;
+}
+
+void SchemaMigrator::migrate() {
+    int version = currentVersion();
+    if (version > latestVersion()) {
+        throw std::runtime_error(
+            QString("Database schema version %1 is newer than this build (%2)")
+                .arg(version).arg(latestVersion()).toStdString());
+    }
+
+    for (const auto& migration : migrations()) {
+        if (migration.version <= version) continue;
+
+        db.transaction();
+        QSqlQuery query(db);
+        for (const auto& statement : migration.statements) {
+            if (!query.exec(statement)) {
+                QString error = query.lastError().text();
+                db.rollback();
+                throw std::runtime_error(
+                    QString("Schema migration %1 (%2) failed: %3")
+                        .arg(migration.version)
+                        .arg(migration.description, error)
+                        .toStdString());
+            }
+        }
+
+        // PRAGMA does not take bound parameters
+        if (!query.exec(QString("PRAGMA user_version = %1").arg(migration.version))
+            || !db.commit()) {
+            QString error = query.lastError().text();
+            db.rollback();
+            throw std::runtime_error(
+                QString("Schema migration %1 (%2) could not be recorded: %3")
+                    .arg(migration.version)
+                    .arg(migration.description, error)
+                    .toStdString());
+        }
+
+        qDebug() << "Applied schema migration" << migration.version << migration.description;
+        version = migration.version;
+    }
+}
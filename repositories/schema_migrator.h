@@ -0,0 +1,38 @@
+#ifndef SCHEMA_MIGRATOR_H
+#define SCHEMA_MIGRATOR_H
+
+#include <QSqlDatabase>
+#include <QString>
+#include <QStringList>
+#include <vector>
+
+// Brings the database schema up to date. The schema version lives in
+// PRAGMA user_version; each pending migration runs in its own transaction
+// and bumps the version, so steps apply exactly once and in order.
+//
+// Append new steps to the end of migrations(); never edit a step that has
+// shipped.
+class SchemaMigrator {
+public:
+    struct Migration {
+        int version;
+        QString description;
+        QStringList statements;
+    };
+
+    explicit SchemaMigrator(const QSqlDatabase& db);
+
+    static const std::vector<Migration>& migrations();
+    static int latestVersion();
+
+    int currentVersion() const;
+
+    // Applies every pending migration. Throws std::runtime_error naming the
+    // failed step; that step is rolled back, earlier ones stay applied.
+    void migrate();
+
+private:
+    QSqlDatabase db;
+};
+
+#endif // SCHEMA_MIGRATOR_H
@@ -0,0 +1,72 @@
+#include "storage_profile.h"
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QDebug>
+
+StorageProfile StorageProfile::durable() {
+    return StorageProfile{"durable", "WAL", "FULL", 8 * 1024, 0, "DEFAULT", 5000};
+}
+
+StorageProfile StorageProfile::balanced() {
+    return StorageProfile{"balanced", "WAL", "NORMAL", 32 * 1024,
+                          256LL * 1024 * 1024, "MEMORY", 5000};
+}
+
+StorageProfile StorageProfile::bulkLoad() {
+    return StorageProfile{"bulk-load", "WAL", "OFF", 128 * 1024,
+                          1024LL * 1024 * 1024, "MEMORY", 30000};
+}
+
+QStringList StorageProfile::presetNames() {
+    return {"durable", "balanced", "bulk-load"};
+}
+
+std::optional<StorageProfile> StorageProfile::fromName(const QString& name) {
+    QString key = name.trimmed().toLower();
+    if (key == "durable") return durable();
+    if (key == "balanced") return balanced();
+    if (key == "bulk-load") return bulkLoad();
+    return std::nullopt;
+}
+
+StorageProfile StorageProfile::fromEnvironment() {
+    QString name = qEnvironmentVariable("WORD_SYSTEM_STORAGE_PROFILE");
+    if (name.isEmpty()) {
+        return balanced();
+    }
+
+    auto profile = fromName(name);
+    if (!profile) {
+        qWarning() << "Unknown storage profile" << name
+                   << "- expected one of" << presetNames() << "; using balanced";
+        return balanced();
+    }
+    return *profile;
+}
+
+bool StorageProfile::apply(QSqlDatabase& db) const {
+    bool readOnly = db.connectOptions().contains("QSQLITE_OPEN_READONLY");
+
+    QStringList pragmas;
+    if (!readOnly) {
+        // journal_mode is stored in the database file, so readers pick up
+        // WAL from whichever writer set it.
+        pragmas << QString("PRAGMA journal_mode = %1").arg(journalMode)
+                << QString("PRAGMA synchronous = %1").arg(synchronous);
+    }
+    pragmas << QString("PRAGMA cache_size = -%1").arg(cacheSizeKiB)
+            << QString("PRAGMA mmap_size = %1").arg(mmapSizeBytes)
+            << QString("PRAGMA temp_store = %1").arg(tempStore)
+            << QString("PRAGMA busy_timeout = %1").arg(busyTimeoutMs);
+
+    bool ok = true;
+    QSqlQuery query(db);
+    for (const auto& pragma : pragmas) {
+        if (!query.exec(pragma)) {
+            qDebug() << "Storage profile" << name << "failed:" << pragma
+                     << "Error:" << query.lastError().text();
+            ok = false;
+        }
+    }
+    return ok;
+}
@@ -0,0 +1,39 @@
+#ifndef STORAGE_PROFILE_H
+#define STORAGE_PROFILE_H
+
+#include <QSqlDatabase>
+#include <QString>
+#include <QStringList>
+#include <optional>
+
+// SQLite tuning applied to every connection right after it is opened.
+// Trades durability against write throughput; pick a preset per deployment
+// with the WORD_SYSTEM_STORAGE_PROFILE environment variable.
+struct StorageProfile {
+    QString name;
+    QString journalMode;    // DELETE, WAL, MEMORY, ...
+    QString synchronous;    // OFF, NORMAL, FULL, EXTRA
+    int cacheSizeKiB;       // page cache per connection
+    qint64 mmapSizeBytes;   // 0 disables memory-mapped I/O
+    QString tempStore;      // DEFAULT, FILE, MEMORY
+    int busyTimeoutMs;      // how long to wait on a locked database
+
+    // Every commit is fsynced; nothing committed is lost on power failure.
+    static StorageProfile durable();
+    // WAL with synchronous=NORMAL: the last commits may roll back after a
+    // power failure, but the database never corrupts.
+    static StorageProfile balanced();
+    // For imports: no fsyncs and large caches. Not safe for everyday use.
+    static StorageProfile bulkLoad();
+
+    static QStringList presetNames();
+    static std::optional<StorageProfile> fromName(const QString& name);
+    // The preset named by WORD_SYSTEM_STORAGE_PROFILE, or balanced().
+    static StorageProfile fromEnvironment();
+
+    // Issues the PRAGMAs on db. Read-only connections skip the ones that
+    // need write access. Returns false if any PRAGMA failed.
+    bool apply(QSqlDatabase& db) const;
+};
+
+#endif // STORAGE_PROFILE_H
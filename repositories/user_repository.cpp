@@ -5,56 +5,60 @@
 #include <QDebug>
 #include <QSqlError>
 
+User UserRepository::readUserRow(const QSqlQuery& query) {
+    User user;
+    user.username = query.value("username").toString().toStdString();
+    user.passwordHash = query.value("password").toString().toStdString();
+    user.stats.totalScore = query.value("total_score").toInt();
+    user.stats.daysStreak = query.value("days_streak").toInt();
+    user.stats.totalWordsLearned = query.value("total_words_learned").toInt();
+    user.stats.lastCheckinDate = std::chrono::system_clock::from_time_t(
+        QDateTime::fromString(query.value("last_checkin_date").toString(),
+                            Qt::ISODate).toSecsSinceEpoch());
+    user.createdAt = std::chrono::system_clock::from_time_t(
+        QDateTime::fromString(query.value("created_at").toString(),
+                            Qt::ISODate).toSecsSinceEpoch());
+    return user;
+}
+
 std::optional<User> UserRepository::findByUsername(const std::string& username) {
-    QSqlQuery query(db);
-    query.prepare("SELECT * FROM users WHERE username = ?");
-    query.addBindValue(QString::fromStdString(username));
+    auto query = cachedQuery("SELECT * FROM users WHERE username = ?");
+    query->addBindValue(QString::fromStdString(username));
     
-    if (query.exec() && query.next()) {
-        User user;
-        user.username = query.value("username").toString().toStdString();
-        user.passwordHash = query.value("password").toString().toStdString();
-        user.stats.totalScore = query.value("total_score").toInt();
-        user.stats.daysStreak = query.value("days_streak").toInt();
-        user.stats.totalWordsLearned = query.value("total_words_learned").toInt();
-        user.stats.lastCheckinDate = std::chrono::system_clock::from_time_t(
-            QDateTime::fromString(query.value("last_checkin_date").toString(),
-                                Qt::ISODate).toSecsSinceEpoch());
-        user.createdAt = std::chrono::system_clock::from_time_t(
-            QDateTime::fromString(query.value("created_at").toString(),
-                                Qt::ISODate).toSecsSinceEpoch());
-        return user;
+    if (query->exec() && query->next()) {
+        return readUserRow(*query);
     }
     
     return std::nullopt;
 }
 
 bool UserRepository::save(const User& user) {
-    QSqlQuery query(db);
-    query.prepare(
+    auto writeLock = lockWriter();
+    auto query = cachedQuery(
         "INSERT INTO users (username, password, total_score, days_streak, "
         "total_words_learned, last_checkin_date, created_at) "
-        "VALUES (?, ?, ?, ?, ?, ?, ?)"
+        "VALUES (?, ?, ?, ?, ?, ?, ?)",
+        Access::Write
     );
     
-    query.addBindValue(QString::fromStdString(user.getUsername()));
-    query.addBindValue(QString::fromStdString(user.getPasswordHash()));
+    query->addBindValue(QString::fromStdString(user.getUsername()));
+    query->addBindValue(QString::fromStdString(user.getPasswordHash()));
     const auto& stats = user.getStats();
-    query.addBindValue(stats.totalScore);
-    query.addBindValue(stats.daysStreak);
-    query.addBindValue(stats.totalWordsLearned);
-    query.addBindValue(QDateTime::fromSecsSinceEpoch(
+    query->addBindValue(stats.totalScore);
+    query->addBindValue(stats.daysStreak);
+    query->addBindValue(stats.totalWordsLearned);
+    query->addBindValue(QDateTime::fromSecsSinceEpoch(
         std::chrono::system_clock::to_time_t(stats.lastCheckinDate))
         .toString(Qt::ISODate));
-    query.addBindValue(QDateTime::fromSecsSinceEpoch(
+    query->addBindValue(QDateTime::fromSecsSinceEpoch(
         std::chrono::system_clock::to_time_t(user.getCreatedAt()))
         .toString(Qt::ISODate));
     
-    if (!query.exec()) {
+    if (!query->exec()) {
         qDebug() << "User save failed:"
                  << "Username:" << QString::fromStdString(user.getUsername())
-                 << "Error:" << query.lastError().text()
-                 << "SQL:" << query.lastQuery();
+                 << "Error:" << query->lastError().text()
+                 << "SQL:" << query->lastQuery();
         return false;
     }
     
@@ -62,55 +66,106 @@ bool UserRepository::save(const User& user) {
 }
 
 bool UserRepository::update(const User& user) {
-    QSqlQuery query(db);
-    query.prepare(
+    auto writeLock = lockWriter();
+    auto query = cachedQuery(
         "UPDATE users SET password = ?, total_score = ?, days_streak = ?, "
         "total_words_learned = ?, last_checkin_date = ? "
-        "WHERE username = ?"
+        "WHERE username = ?",
+        Access::Write
     );
     
-    query.addBindValue(QString::fromStdString(user.passwordHash));
-    query.addBindValue(user.stats.totalScore);
-    query.addBindValue(user.stats.daysStreak);
-    query.addBindValue(user.stats.totalWordsLearned);
-    query.addBindValue(QDateTime::fromSecsSinceEpoch(
+    query->addBindValue(QString::fromStdString(user.passwordHash));
+    query->addBindValue(user.stats.totalScore);
+    query->addBindValue(user.stats.daysStreak);
+    query->addBindValue(user.stats.totalWordsLearned);
+    query->addBindValue(QDateTime::fromSecsSinceEpoch(
         std::chrono::system_clock::to_time_t(user.stats.lastCheckinDate))
         .toString(Qt::ISODate));
-    query.addBindValue(QString::fromStdString(user.username));
+    query->addBindValue(QString::fromStdString(user.username));
     
-    return query.exec();
+    return query->exec();
+}
+
+bool UserRepository::addScore(const std::string& username, int points) {
+    auto writeLock = lockWriter();
+    auto query = cachedQuery(
+        "UPDATE users SET total_score = total_score + ? WHERE username = ?",
+        Access::Write
+    );
+    query->addBindValue(points);
+    query->addBindValue(QString::fromStdString(username));
+    
+    return query->exec();
+}
+
+std::string UserRepository::getScheduler(const std::string& username) {
+    auto query = cachedQuery("SELECT scheduler FROM users WHERE username = ?");
+    query->addBindValue(QString::fromStdString(username));
+    
+    if (query->exec() && query->next()) {
+        return query->value(0).toString().toStdString();
+    }
+    return {};
+}
+
+bool UserRepository::setScheduler(const std::string& username, const std::string& scheduler) {
+    auto writeLock = lockWriter();
+    auto query = cachedQuery(
+        "UPDATE users SET scheduler = ? WHERE username = ?",
+        Access::Write
+    );
+    query->addBindValue(QString::fromStdString(scheduler));
+    query->addBindValue(QString::fromStdString(username));
+    
+    return query->exec();
 }
 
 bool UserRepository::remove(const std::string& username) {
-    QSqlQuery query(db);
+    auto writeLock = lockWriter();
+    QSqlQuery query(db(Access::Write));
     query.prepare("DELETE FROM users WHERE username = ?");
     query.addBindValue(QString::fromStdString(username));
     return query.exec();
 }
 
 std::vector<User> UserRepository::getTopUsers(int limit) {
+    // Reads the first rows of idx_users_score
     std::vector<User> users;
-    QSqlQuery query(db);
-    query.prepare(
-        "SELECT * FROM users ORDER BY total_score DESC LIMIT ?"
+    auto query = cachedQuery(
+        "SELECT * FROM users ORDER BY total_score DESC, username LIMIT ?"
     );
-    query.addBindValue(limit);
+    query->addBindValue(limit);
     
-    if (query.exec()) {
-        while (query.next()) {
-            auto user = findByUsername(
-                query.value("username").toString().toStdString());
-            if (user) {
-                users.push_back(*user);
-            }
-        }
+    if (!query->exec()) {
+        qDebug() << "Error loading top users: " << query->lastError().text();
+        return users;
+    }
+    while (query->next()) {
+        users.push_back(readUserRow(*query));
     }
     
     return users;
 }
 
+std::vector<std::pair<std::string, int>> UserRepository::getAllScores() {
+    // Covered by idx_users_score, already in leaderboard order
+    std::vector<std::pair<std::string, int>> scores;
+    QSqlQuery query(db());
+    query.setForwardOnly(true);
+    query.prepare("SELECT username, total_score FROM users ORDER BY total_score DESC, username");
+    
+    if (!query.exec()) {
+        qDebug() << "Error loading scores: " << query.lastError().text();
+        return scores;
+    }
+    while (query.next()) {
+        scores.emplace_back(query.value(0).toString().toStdString(), query.value(1).toInt());
+    }
+    return scores;
+}
+
 double UserRepository::getAverageWordsPerUser() {
-    QSqlQuery query(db);
+    QSqlQuery query(db());
     query.exec("SELECT AVG(total_words_learned) FROM users");
     
     if (query.next()) {
@@ -122,17 +177,13 @@ double UserRepository::getAverageWordsPerUser() {
 
 std::vector<User> UserRepository::getUsersByStreak(int minStreak) {
     std::vector<User> users;
-    QSqlQuery query(db);
+    QSqlQuery query(db());
     query.prepare("SELECT * FROM users WHERE days_streak >= ?");
     query.addBindValue(minStreak);
     
     if (query.exec()) {
         while (query.next()) {
-            auto user = findByUsername(
-                query.value("username").toString().toStdString());
-            if (user) {
-                users.push_back(*user);
-            }
+            users.push_back(readUserRow(query));
         }
     }
     
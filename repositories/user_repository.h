@@ -4,6 +4,7 @@
 #include "base_repository.h"
 #include "../models/user.h"
 #include <optional>
+#include <utility>
 #include <vector>
 
 class UserRepository : public BaseRepository {
@@ -12,11 +13,23 @@ public:
     bool save(const User& user);
     bool update(const User& user);
     bool remove(const std::string& username);
+    // Adds points in place, so it is safe to apply after other writes to
+    // the row. Returns false only on a database error.
+    bool addScore(const std::string& username, int points);
+    // Name of the SchedulerEngine that last set the user's due dates;
+    // empty if the user does not exist
+    std::string getScheduler(const std::string& username);
+    bool setScheduler(const std::string& username, const std::string& scheduler);
     
     // Statistics and rankings
     std::vector<User> getTopUsers(int limit = 10);
+    // Every user's score, best first; loads the Leaderboard
+    std::vector<std::pair<std::string, int>> getAllScores();
     double getAverageWordsPerUser();
     std::vector<User> getUsersByStreak(int minStreak);
+
+private:
+    static User readUserRow(const QSqlQuery& query);
 };
 
 #endif // USER_REPOSITORY_H
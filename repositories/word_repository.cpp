@@ -3,50 +3,228 @@
 #include <QVariant>
 #include <QDateTime>
 #include <QDebug>
+#include <QSqlError>
+#include <QStringList>
+#include <QVector>
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
 
-std::optional<Word> WordRepository::findByEnglish(const std::string& english) {
-    QSqlQuery query(db);
-    query.prepare("SELECT * FROM words WHERE english = ?");
-    query.addBindValue(QString::fromStdString(english));
-    
-    if (query.exec() && query.next()) {
+namespace {
+    // SQLite builds older than 3.32 cap bound parameters at 999 per statement.
+    constexpr int kMaxKeysPerQuery = 500;
+
+    // findDueForReview samples among this many times `limit` overdue cards
+    constexpr int kDueOversample = 4;
+
+    // sampleRandomWords gives up on id probing after this many batches
+    constexpr int kSampleRounds = 6;
+
+    // CJK unified ideographs, including the extension blocks
+    bool isHan(uint c) {
+        return (c >= 0x3400 && c <= 0x4DBF) || (c >= 0x4E00 && c <= 0x9FFF)
+            || (c >= 0xF900 && c <= 0xFAFF) || (c >= 0x20000 && c <= 0x3134F);
+    }
+
+    // Puts a space around each Han character, which word_search's tokenizer
+    // would otherwise keep together with its neighbours. Written to
+    // words.chinese_terms; migration 12 backfills it with the same rule.
+    QString splitHan(const QString& text) {
+        QVector<uint> split;
+        for (uint c : text.toUcs4()) {
+            if (isHan(c)) {
+                split << ' ' << c << ' ';
+            } else {
+                split << c;
+            }
+        }
+        return QString::fromUcs4(split.constData(), split.size());
+    }
+
+    // Turns free text into an FTS5 query: every term quoted (so operators
+    // and punctuation are taken literally) and matched as a prefix. Han
+    // characters are split as in the index, so a term like 图书 becomes a
+    // phrase of adjacent characters and matches inside 图书馆.
+    QString toPrefixQuery(const QString& text) {
+        QStringList terms;
+        for (const auto& term : text.simplified().split(' ', Qt::SkipEmptyParts)) {
+            QString quoted = splitHan(term).simplified();
+            quoted.replace('"', "\"\"");
+            terms << "\"" + quoted + "\"*";
+        }
+        return terms.join(' ');
+    }
+
+    // "IN (?, ?, ...)" with kMaxKeysPerQuery placeholders. Key lists are
+    // padded to this width so every chunk shares one cached statement.
+    const QString& keyListPlaceholders() {
+        static const QString placeholders = [] {
+            QStringList marks;
+            for (int i = 0; i < kMaxKeysPerQuery; ++i) {
+                marks << "?";
+            }
+            return QString("IN (%1)").arg(marks.join(","));
+        }();
+        return placeholders;
+    }
+
+    // Pads a non-empty bind list to kMaxKeysPerQuery values by repeating
+    // the last one
+    QVariantList padKeys(QVariantList values) {
+        while (values.size() < kMaxKeysPerQuery) {
+            values << values.last();
+        }
+        return values;
+    }
+
+    // Keys [begin, end) of keys, padded to kMaxKeysPerQuery values.
+    QVariantList keyChunk(const std::vector<std::string>& keys, size_t begin, size_t end) {
+        QVariantList values;
+        for (size_t i = begin; i < end; ++i) {
+            values << QString::fromStdString(keys[i]);
+        }
+        return padKeys(std::move(values));
+    }
+
+    std::mt19937& randomEngine() {
+        // Repositories are used from several threads
+        thread_local std::mt19937 engine{std::random_device{}()};
+        return engine;
+    }
+
+    Word readWordRow(const QSqlQuery& query) {
         Word word(
             query.value("english").toString().toStdString(),
             query.value("part_of_speech").toString().toStdString(),
             query.value("chinese").toString().toStdString()
         );
-        
+
         // Load learning stats
         word.getStats().frequency = query.value("frequency").toInt();
         word.getStats().correctCount = query.value("correct_count").toInt();
         word.getStats().totalAttempts = query.value("total_attempts").toInt();
-        
-        // Load definitions
-        QSqlQuery defQuery(db);
-        defQuery.prepare("SELECT * FROM word_definitions WHERE english = ?");
-        defQuery.addBindValue(QString::fromStdString(english));
-        
-        if (defQuery.exec()) {
-            while (defQuery.next()) {
-                word.addDefinition(
-                    defQuery.value("definition_type").toString().toStdString(),
-                    defQuery.value("content").toString().toStdString()
+
+        return word;
+    }
+}
+
+std::vector<Word> WordRepository::hydrate(QSqlQuery& query) {
+    std::vector<Word> words;
+    while (query.next()) {
+        words.push_back(readWordRow(query));
+    }
+    loadDetails(words);
+    return words;
+}
+
+void WordRepository::loadDetails(std::vector<Word>& words) {
+    // Restrict the child queries to the keys we actually hold, in chunks
+    // small enough to stay under the bound parameter limit.
+    static const QString scope = "WHERE english " + keyListPlaceholders();
+
+    std::vector<std::string> keys;
+    keys.reserve(words.size());
+    for (const auto& word : words) {
+        keys.push_back(word.getEnglish());
+    }
+
+    for (size_t begin = 0; begin < words.size(); begin += kMaxKeysPerQuery) {
+        size_t end = std::min(words.size(), begin + kMaxKeysPerQuery);
+        std::vector<Word> chunk(std::make_move_iterator(words.begin() + begin),
+                                std::make_move_iterator(words.begin() + end));
+        loadDetails(chunk, scope, keyChunk(keys, begin, end));
+        std::move(chunk.begin(), chunk.end(), words.begin() + begin);
+    }
+}
+
+std::vector<Word> WordRepository::loadByKeys(const std::vector<std::string>& keys,
+                                            bool withDetails) {
+    std::vector<Word> words;
+    for (size_t begin = 0; begin < keys.size(); begin += kMaxKeysPerQuery) {
+        size_t end = std::min(keys.size(), begin + kMaxKeysPerQuery);
+        auto query = cachedQuery("SELECT * FROM words WHERE english " + keyListPlaceholders());
+        for (const auto& value : keyChunk(keys, begin, end)) {
+            query->addBindValue(value);
+        }
+        if (query->exec()) {
+            while (query->next()) {
+                words.push_back(readWordRow(*query));
+            }
+        }
+    }
+    if (withDetails) {
+        loadDetails(words);
+    }
+
+    // Return the words in the order they were asked for
+    std::unordered_map<std::string, size_t> order;
+    for (size_t i = 0; i < keys.size(); ++i) {
+        order.emplace(keys[i], i);
+    }
+    std::sort(words.begin(), words.end(), [&order](const Word& a, const Word& b) {
+        return order[a.getEnglish()] < order[b.getEnglish()];
+    });
+    return words;
+}
+
+void WordRepository::loadDetails(std::vector<Word>& words,
+                                 const QString& scope,
+                                 const QVariantList& binds) {
+    if (words.empty()) return;
+
+    std::unordered_map<std::string, size_t> index;
+    index.reserve(words.size());
+    for (size_t i = 0; i < words.size(); ++i) {
+        index.emplace(words[i].getEnglish(), i);
+    }
+
+    // Load definitions
+    auto defQuery = cachedQuery(
+        "SELECT english, definition_type, content FROM word_definitions " + scope);
+    for (const auto& value : binds) {
+        defQuery->addBindValue(value);
+    }
+
+    if (defQuery->exec()) {
+        while (defQuery->next()) {
+            auto it = index.find(defQuery->value(0).toString().toStdString());
+            if (it != index.end()) {
+                words[it->second].addDefinition(
+                    defQuery->value(1).toString().toStdString(),
+                    defQuery->value(2).toString().toStdString()
                 );
             }
         }
-        
-        // Load categories
-        QSqlQuery catQuery(db);
-        catQuery.prepare("SELECT category FROM word_categories WHERE english = ?");
-        catQuery.addBindValue(QString::fromStdString(english));
-        
-        if (catQuery.exec()) {
-            while (catQuery.next()) {
-                word.addCategory(catQuery.value("category").toString().toStdString());
+    }
+
+    // Load categories
+    auto catQuery = cachedQuery("SELECT english, category FROM word_categories " + scope);
+    for (const auto& value : binds) {
+        catQuery->addBindValue(value);
+    }
+
+    if (catQuery->exec()) {
+        while (catQuery->next()) {
+            auto it = index.find(catQuery->value(0).toString().toStdString());
+            if (it != index.end()) {
+                words[it->second].addCategory(catQuery->value(1).toString().toStdString());
             }
         }
-        
-        return word;
+    }
+}
+
+std::optional<Word> WordRepository::findByEnglish(const std::string& english) {
+    auto query = cachedQuery("SELECT * FROM words WHERE english = ?");
+    query->addBindValue(QString::fromStdString(english));
+    
+    if (query->exec() && query->next()) {
+        std::vector<Word> words{readWordRow(*query)};
+        loadDetails(words, "WHERE english = ?", {QString::fromStdString(english)});
+        return std::move(words.front());
     }
     
     return std::nullopt;
@@ -54,9 +232,10 @@ std::optional<Word> WordRepository::findByEnglish(const std::string& english) {
 
 std::vector<Word> WordRepository::findByCategory(const std::string& category) {
     std::vector<Word> words;
-    QSqlQuery query(db);
+    QSqlQuery query(db());
+    query.setForwardOnly(true);
     query.prepare(
-        "SELECT w.* FROM words w "
+        "SELECT DISTINCT w.* FROM words w "
         "INNER JOIN word_categories wc ON w.english = wc.english "
         "WHERE wc.category = ?"
     );
@@ -64,233 +243,853 @@ std::vector<Word> WordRepository::findByCategory(const std::string& category) {
     
     if (query.exec()) {
         while (query.next()) {
-            auto word = findByEnglish(query.value("english").toString().toStdString());
-            if (word) {
-                words.push_back(*word);
-            }
+            words.push_back(readWordRow(query));
         }
+        loadDetails(words,
+                    "WHERE english IN (SELECT english FROM word_categories WHERE category = ?)",
+                    {QString::fromStdString(category)});
     }
     
     return words;
 }
 
-std::vector<Word> WordRepository::findDueForReview(const std::string& username, int limit) {
+std::vector<Word> WordRepository::search(const std::string& text, int limit) {
     std::vector<Word> words;
-    QSqlQuery query(db);
-    query.prepare(
-        "SELECT w.* FROM words w "
-        "LEFT JOIN learning_records lr ON w.english = lr.word AND lr.username = ? "
-        "WHERE lr.last_review_date IS NULL "
-        "OR julianday('now') - julianday(lr.last_review_date) >= "
-        "CASE "
-        "   WHEN lr.mastery_level = 1 THEN 1 "  // Review after 1 day
-        "   WHEN lr.mastery_level = 2 THEN 3 "  // Review after 3 days
-        "   WHEN lr.mastery_level = 3 THEN 7 "  // Review after 7 days
-        "   ELSE 14 "                           // Review after 14 days
-        "END "
-        "ORDER BY RANDOM() LIMIT ?"
+    QString match = toPrefixQuery(QString::fromStdString(text));
+    if (match.isEmpty() || limit <= 0) return words;
+    
+    // Rank every match and keep the best `limit` inside FTS5 (a bounded
+    // sort), then hydrate only those; the outer ORDER BY restores the rank
+    // order after the join
+    auto query = cachedQuery(
+        "SELECT w.* FROM ("
+        "SELECT rowid, rank FROM word_search WHERE word_search MATCH ? "
+        "ORDER BY rank LIMIT ?"
+        ") s JOIN words w ON w.id = s.rowid "
+        "ORDER BY s.rank"
     );
-    query.addBindValue(QString::fromStdString(username));
-    query.addBindValue(limit);
+    query->addBindValue(match);
+    query->addBindValue(limit);
     
-    if (query.exec()) {
-        while (query.next()) {
-            auto word = findByEnglish(query.value("english").toString().toStdString());
-            if (word) {
-                words.push_back(*word);
+    if (query->exec()) {
+        words = hydrate(*query);
+    } else {
+        qDebug() << "Error searching words: " << query->lastError().text();
+    }
+    return words;
+}
+
+std::vector<Word> WordRepository::findDueForReview(const std::string& username, int limit,
+                                                   const std::set<std::string>& exclude) {
+    if (limit <= 0) return {};
+    
+    const QString user = QString::fromStdString(username);
+    auto& rng = randomEngine();
+    std::vector<std::string> keys;
+    
+    // Cards that are due: a range scan over (username, next_review_at),
+    // most overdue first. Oversample and pick at random among them rather
+    // than sorting every card with ORDER BY RANDOM().
+    {
+        auto query = cachedQuery(
+            "SELECT word FROM learning_records "
+            "WHERE username = ? AND next_review_at <= ? "
+            "ORDER BY next_review_at LIMIT ?"
+        );
+        query->addBindValue(user);
+        query->addBindValue(QDateTime::currentSecsSinceEpoch());
+        query->addBindValue(limit * kDueOversample + static_cast<int>(exclude.size()));
+        
+        if (query->exec()) {
+            while (query->next()) {
+                auto key = query->value(0).toString().toStdString();
+                if (!exclude.count(key)) {
+                    keys.push_back(std::move(key));
+                }
             }
         }
     }
     
+    if (static_cast<int>(keys.size()) > limit) {
+        // Partial Fisher-Yates: the first `limit` keys become a uniform sample
+        for (size_t i = 0; i < static_cast<size_t>(limit); ++i) {
+            std::uniform_int_distribution<size_t> pick(i, keys.size() - 1);
+            std::swap(keys[i], keys[pick(rng)]);
+        }
+        keys.resize(limit);
+    }
+    
+    appendNewWords(username, limit - static_cast<int>(keys.size()), exclude, keys);
+    
+    return loadByKeys(keys);
+}
+
+std::vector<Word> WordRepository::findReviewWords(const std::string& username,
+                                                  const std::vector<std::string>& dueWords,
+                                                  int limit,
+                                                  const std::set<std::string>& exclude) {
+    if (limit <= 0) return {};
+    
+    std::vector<std::string> keys;
+    for (const auto& key : dueWords) {
+        if (static_cast<int>(keys.size()) >= limit) break;
+        if (!exclude.count(key)) {
+            keys.push_back(key);
+        }
+    }
+    
+    // Due words that have since been deleted are missing from loadByKeys;
+    // their places go to new words
+    auto words = loadByKeys(keys);
+    std::set<std::string> skip(exclude);
+    skip.insert(keys.begin(), keys.end());
+    std::vector<std::string> fresh;
+    appendNewWords(username, limit - static_cast<int>(words.size()), skip, fresh);
+    
+    auto extra = loadByKeys(fresh);
+    std::move(extra.begin(), extra.end(), std::back_inserter(words));
     return words;
 }
 
+std::vector<std::pair<std::string, int64_t>> WordRepository::getReviewSchedule(
+    const std::string& username) {
+    std::vector<std::pair<std::string, int64_t>> schedule;
+    QSqlQuery query(db());
+    query.setForwardOnly(true);
+    query.prepare("SELECT word, next_review_at FROM learning_records WHERE username = ?");
+    query.addBindValue(QString::fromStdString(username));
+    
+    if (!query.exec()) {
+        qDebug() << "Error loading review schedule: " << query.lastError().text();
+        return schedule;
+    }
+    while (query.next()) {
+        schedule.emplace_back(query.value(0).toString().toStdString(),
+                              query.value(1).toLongLong());
+    }
+    return schedule;
+}
+
+void WordRepository::appendNewWords(const std::string& username, int missing,
+                                    const std::set<std::string>& exclude,
+                                    std::vector<std::string>& keys) {
+    // Reads on from a random id and wraps around to the start of the table
+    if (missing <= 0) return;
+    
+    const QString user = QString::fromStdString(username);
+    auto& rng = randomEngine();
+    qint64 start = 0;
+    {
+        auto bounds = cachedQuery("SELECT MIN(id), MAX(id) FROM words");
+        if (bounds->exec() && bounds->next() && !bounds->value(0).isNull()) {
+            std::uniform_int_distribution<qint64> pick(
+                bounds->value(0).toLongLong(), bounds->value(1).toLongLong());
+            start = pick(rng);
+        }
+    }
+    
+    const char* const scans[] = {
+        "SELECT english FROM words w WHERE w.id >= ? "
+        "AND NOT EXISTS (SELECT 1 FROM learning_records lr "
+        "WHERE lr.username = ? AND lr.word = w.english) "
+        "ORDER BY w.id LIMIT ?",
+        "SELECT english FROM words w WHERE w.id < ? "
+        "AND NOT EXISTS (SELECT 1 FROM learning_records lr "
+        "WHERE lr.username = ? AND lr.word = w.english) "
+        "ORDER BY w.id LIMIT ?",
+    };
+    for (const char* sql : scans) {
+        if (missing <= 0) break;
+        
+        auto query = cachedQuery(sql);
+        query->addBindValue(start);
+        query->addBindValue(user);
+        query->addBindValue(missing + static_cast<int>(exclude.size()));
+        
+        if (query->exec()) {
+            while (missing > 0 && query->next()) {
+                auto key = query->value(0).toString().toStdString();
+                if (!exclude.count(key)) {
+                    keys.push_back(std::move(key));
+                    missing--;
+                }
+            }
+        }
+    }
+}
+
+std::vector<Word> WordRepository::sampleRandomWords(int count, const std::string& category,
+                                                  const std::string& partOfSpeech) {
+    if (count <= 0) return {};
+    
+    auto& rng = randomEngine();
+    qint64 minId = 0;
+    qint64 maxId = -1;
+    {
+        // Both ends of the rowid b-tree; no scan
+        auto bounds = cachedQuery("SELECT MIN(id), MAX(id) FROM words");
+        if (bounds->exec() && bounds->next() && !bounds->value(0).isNull()) {
+            minId = bounds->value(0).toLongLong();
+            maxId = bounds->value(1).toLongLong();
+        }
+    }
+    if (maxId < minId) return {};
+    
+    const QString categoryValue = QString::fromStdString(category);
+    const QString partOfSpeechValue = QString::fromStdString(partOfSpeech);
+    const size_t wanted = static_cast<size_t>(count);
+    const qint64 span = maxId - minId + 1;
+    std::uniform_int_distribution<qint64> pickId(minId, maxId);
+    std::unordered_set<qint64> probed;
+    std::vector<std::string> keys;
+    
+    // Probe random ids in batches. Gaps left by deleted words and rows
+    // that fail the filters are rejected, which keeps the sample uniform
+    // over the matching words; each batch is sized by the hit rate so far.
+    size_t hits = 0;
+    for (int round = 0; round < kSampleRounds && keys.size() < wanted
+         && static_cast<qint64>(probed.size()) < span; ++round) {
+        size_t missing = wanted - keys.size();
+        double hitRate = probed.empty()
+            ? 1.0 : std::max(static_cast<double>(hits) / probed.size(), 0.01);
+        size_t batchSize = std::min<size_t>(
+            kMaxKeysPerQuery, static_cast<size_t>(2.0 * missing / hitRate) + 1);
+        
+        QVariantList ids;
+        for (size_t attempt = 0; static_cast<size_t>(ids.size()) < batchSize
+             && attempt < 4 * batchSize; ++attempt) {
+            qint64 id = pickId(rng);
+            if (probed.insert(id).second) {
+                ids << id;
+            }
+        }
+        if (ids.isEmpty()) break;
+        
+        auto query = cachedQuery(
+            "SELECT english FROM words WHERE id " + keyListPlaceholders() + " "
+            "AND (? = '' OR part_of_speech = ?) "
+            "AND (? = '' OR EXISTS (SELECT 1 FROM word_categories c "
+            "WHERE c.english = words.english AND c.category = ?))");
+        for (const auto& id : padKeys(ids)) {
+            query->addBindValue(id);
+        }
+        query->addBindValue(partOfSpeechValue);
+        query->addBindValue(partOfSpeechValue);
+        query->addBindValue(categoryValue);
+        query->addBindValue(categoryValue);
+        
+        if (!query->exec()) {
+            qDebug() << "Error sampling words: " << query->lastError().text();
+            return {};
+        }
+        // Hits come back in id order, so take the missing ones from all of
+        // them uniformly (partial Fisher-Yates) rather than the first few
+        std::vector<std::string> batch;
+        while (query->next()) {
+            batch.push_back(query->value(0).toString().toStdString());
+        }
+        hits += batch.size();
+        size_t take = std::min(missing, batch.size());
+        for (size_t i = 0; i < take; ++i) {
+            std::uniform_int_distribution<size_t> pick(i, batch.size() - 1);
+            std::swap(batch[i], batch[pick(rng)]);
+            keys.push_back(std::move(batch[i]));
+        }
+    }
+    
+    // Filters too selective for probing: sample among the matching rows
+    // directly. With a category that reads only the category's index range.
+    if (keys.size() < wanted) {
+        std::set<std::string> taken(keys.begin(), keys.end());
+        auto query = category.empty()
+            ? cachedQuery("SELECT english FROM words "
+                          "WHERE (? = '' OR part_of_speech = ?) "
+                          "ORDER BY random() LIMIT ?")
+            : cachedQuery("SELECT w.english FROM word_categories c "
+                          "JOIN words w ON w.english = c.english "
+                          "WHERE c.category = ? AND (? = '' OR w.part_of_speech = ?) "
+                          "ORDER BY random() LIMIT ?");
+        if (!category.empty()) {
+            query->addBindValue(categoryValue);
+        }
+        query->addBindValue(partOfSpeechValue);
+        query->addBindValue(partOfSpeechValue);
+        query->addBindValue(static_cast<int>(wanted + taken.size()));
+        
+        if (query->exec()) {
+            while (keys.size() < wanted && query->next()) {
+                auto key = query->value(0).toString().toStdString();
+                if (taken.insert(key).second) {
+                    keys.push_back(std::move(key));
+                }
+            }
+        }
+    }
+    
+    // Probe batches follow each other in order, and the fallback rows come last
+    std::shuffle(keys.begin(), keys.end(), rng);
+    return loadByKeys(keys);
+}
+
+std::map<std::string, CardState> WordRepository::getCardStates(
+    const std::string& username, const std::vector<std::string>& words) {
+    std::map<std::string, CardState> cards;
+    for (size_t begin = 0; begin < words.size(); begin += kMaxKeysPerQuery) {
+        size_t end = std::min(words.size(), begin + kMaxKeysPerQuery);
+        auto query = cachedQuery(
+            "SELECT word, mastery_level, stability, difficulty, reps, lapses, "
+            "last_review_at, next_review_at FROM learning_records "
+            "WHERE username = ? AND word " + keyListPlaceholders());
+        query->addBindValue(QString::fromStdString(username));
+        for (const auto& value : keyChunk(words, begin, end)) {
+            query->addBindValue(value);
+        }
+        if (query->exec()) {
+            while (query->next()) {
+                CardState card;
+                card.masteryLevel = query->value(1).toInt();
+                card.stability = query->value(2).toDouble();
+                card.difficulty = query->value(3).toDouble();
+                card.reps = query->value(4).toInt();
+                card.lapses = query->value(5).toInt();
+                card.lastReviewAt = query->value(6).toLongLong();
+                card.nextReviewAt = query->value(7).toLongLong();
+                cards[query->value(0).toString().toStdString()] = card;
+            }
+        }
+    }
+    return cards;
+}
+
+bool WordRepository::rescheduleCards(const std::string& username,
+                                     const SchedulerEngine& engine, int& changed) {
+    changed = 0;
+    const QString user = QString::fromStdString(username);
+    
+    auto writeLock = lockWriter();
+    beginTransaction();
+    
+    try {
+        CardBatch batch;
+        QSqlQuery query(db(Access::Write));
+        query.setForwardOnly(true);
+        query.prepare("SELECT word, stability, last_review_at, next_review_at "
+                      "FROM learning_records WHERE username = ?");
+        query.addBindValue(user);
+        
+        if (!query.exec()) {
+            throw std::runtime_error(query.lastError().text().toStdString());
+        }
+        while (query.next()) {
+            batch.words.push_back(query.value(0).toString().toStdString());
+            batch.stability.push_back(query.value(1).toDouble());
+            batch.lastReviewAt.push_back(query.value(2).toLongLong());
+            batch.nextReviewAt.push_back(query.value(3).toLongLong());
+        }
+        query.finish();
+        
+        std::vector<int64_t> previous = batch.nextReviewAt;
+        engine.reschedule(batch);
+        
+        auto update = cachedQuery(
+            "UPDATE learning_records SET next_review_at = ? WHERE username = ? AND word = ?",
+            Access::Write
+        );
+        for (size_t i = 0; i < batch.size(); ++i) {
+            if (batch.nextReviewAt[i] == previous[i]) continue;
+            
+            update->addBindValue(static_cast<qint64>(batch.nextReviewAt[i]));
+            update->addBindValue(user);
+            update->addBindValue(QString::fromStdString(batch.words[i]));
+            
+            if (!update->exec()) {
+                throw std::runtime_error("Failed to update due date");
+            }
+            changed++;
+        }
+        
+        if (!commitTransaction()) {
+            changed = 0;
+            return false;
+        }
+        return true;
+    } catch (const std::exception& e) {
+        rollbackTransaction();
+        changed = 0;
+        qDebug() << "Error rescheduling cards: " << e.what();
+        return false;
+    }
+}
+
 bool WordRepository::save(const Word& word) {
-    db.transaction();
+    auto writeLock = lockWriter();
+    beginTransaction();
     
     try {
-        QSqlQuery query(db);
-        query.prepare(
-            "INSERT INTO words (english, part_of_speech, chinese, frequency, "
-            "correct_count, total_attempts) VALUES (?, ?, ?, ?, ?, ?)"
+        auto query = cachedQuery(
+            "INSERT INTO words (english, part_of_speech, chinese, chinese_terms, "
+            "frequency, correct_count, total_attempts) VALUES (?, ?, ?, ?, ?, ?, ?)",
+            Access::Write
         );
-        query.addBindValue(QString::fromStdString(word.getEnglish()));
-        query.addBindValue(QString::fromStdString(word.getPartOfSpeech()));
-        query.addBindValue(QString::fromStdString(word.getChinese()));
-        query.addBindValue(word.getStats().frequency);
-        query.addBindValue(word.getStats().correctCount);
-        query.addBindValue(word.getStats().totalAttempts);
+        query->addBindValue(QString::fromStdString(word.getEnglish()));
+        query->addBindValue(QString::fromStdString(word.getPartOfSpeech()));
+        query->addBindValue(QString::fromStdString(word.getChinese()));
+        query->addBindValue(splitHan(QString::fromStdString(word.getChinese())));
+        query->addBindValue(word.getStats().frequency);
+        query->addBindValue(word.getStats().correctCount);
+        query->addBindValue(word.getStats().totalAttempts);
         
-        if (!query.exec()) {
+        if (!query->exec()) {
             throw std::runtime_error("Failed to save word");
         }
         
         // Save definitions
+        auto defQuery = cachedQuery(
+            "INSERT INTO word_definitions (english, definition_type, content) "
+            "VALUES (?, ?, ?)",
+            Access::Write
+        );
         for (const auto& def : word.getDefinitions()) {
-            QSqlQuery defQuery(db);
-            defQuery.prepare(
-                "INSERT INTO word_definitions (english, definition_type, content) "
-                "VALUES (?, ?, ?)"
-            );
-            defQuery.addBindValue(QString::fromStdString(word.getEnglish()));
-            defQuery.addBindValue(QString::fromStdString(def.type));
-            defQuery.addBindValue(QString::fromStdString(def.content));
+            defQuery->addBindValue(QString::fromStdString(word.getEnglish()));
+            defQuery->addBindValue(QString::fromStdString(def.type));
+            defQuery->addBindValue(QString::fromStdString(def.content));
             
-            if (!defQuery.exec()) {
+            if (!defQuery->exec()) {
                 throw std::runtime_error("Failed to save word definition");
             }
         }
         
         // Save categories
+        auto catQuery = cachedQuery(
+            "INSERT INTO word_categories (english, category) VALUES (?, ?)",
+            Access::Write
+        );
         for (const auto& category : word.getCategories()) {
-            QSqlQuery catQuery(db);
-            catQuery.prepare(
-                "INSERT INTO word_categories (english, category) VALUES (?, ?)"
-            );
-            catQuery.addBindValue(QString::fromStdString(word.getEnglish()));
-            catQuery.addBindValue(QString::fromStdString(category));
+            catQuery->addBindValue(QString::fromStdString(word.getEnglish()));
+            catQuery->addBindValue(QString::fromStdString(category));
             
-            if (!catQuery.exec()) {
+            if (!catQuery->exec()) {
                 throw std::runtime_error("Failed to save word category");
             }
         }
         
-        db.commit();
-        return true;
+        return commitTransaction();
     } catch (const std::exception& e) {
-        db.rollback();
+        rollbackTransaction();
         qDebug() << "Error saving word: " << e.what();
         return false;
     }
 }
 
 bool WordRepository::update(const Word& word) {
-    db.transaction();
+    auto writeLock = lockWriter();
+    beginTransaction();
     
     try {
-        QSqlQuery query(db);
-        query.prepare(
-            "UPDATE words SET part_of_speech = ?, chinese = ?, frequency = ?, "
-            "correct_count = ?, total_attempts = ? WHERE english = ?"
-        );
-        query.addBindValue(QString::fromStdString(word.getPartOfSpeech()));
-        query.addBindValue(QString::fromStdString(word.getChinese()));
-        query.addBindValue(word.getStats().frequency);
-        query.addBindValue(word.getStats().correctCount);
-        query.addBindValue(word.getStats().totalAttempts);
-        query.addBindValue(QString::fromStdString(word.getEnglish()));
+        const QString english = QString::fromStdString(word.getEnglish());
         
-        if (!query.exec()) {
-            throw std::runtime_error("Failed to update word");
+        // Compare against the stored row and write only the changed columns.
+        // The counters are left alone: incrementStats and recordResults own
+        // them, and the caller's copy may predate increments still queued.
+        auto current = cachedQuery(
+            "SELECT part_of_speech, chinese FROM words WHERE english = ?",
+            Access::Write
+        );
+        current->addBindValue(english);
+        if (!current->exec() || !current->next()) {
+            throw std::runtime_error("Failed to update word: word not found");
         }
         
-        // Update definitions (delete and re-insert)
-        QSqlQuery delDefQuery(db);
-        delDefQuery.prepare("DELETE FROM word_definitions WHERE english = ?");
-        delDefQuery.addBindValue(QString::fromStdString(word.getEnglish()));
+        const QString chinese = QString::fromStdString(word.getChinese());
+        const std::pair<const char*, QVariant> columns[] = {
+            {"part_of_speech", QString::fromStdString(word.getPartOfSpeech())},
+            {"chinese", chinese},
+        };
         
-        if (!delDefQuery.exec()) {
-            throw std::runtime_error("Failed to delete word definitions");
+        QStringList assignments;
+        QVariantList values;
+        for (int i = 0; i < static_cast<int>(std::size(columns)); ++i) {
+            if (current->value(i) != columns[i].second) {
+                assignments << QString("%1 = ?").arg(columns[i].first);
+                values << columns[i].second;
+            }
+        }
+        // The search index reads chinese through chinese_terms
+        if (current->value(1) != chinese) {
+            assignments << "chinese_terms = ?";
+            values << splitHan(chinese);
         }
+        current->finish();
         
-        for (const auto& def : word.getDefinitions()) {
-            QSqlQuery defQuery(db);
-            defQuery.prepare(
-                "INSERT INTO word_definitions (english, definition_type, content) "
-                "VALUES (?, ?, ?)"
+        if (!assignments.isEmpty()) {
+            // At most 2^2 distinct statements, so they can share the cache
+            auto query = cachedQuery(
+                QString("UPDATE words SET %1 WHERE english = ?").arg(assignments.join(", ")),
+                Access::Write
             );
-            defQuery.addBindValue(QString::fromStdString(word.getEnglish()));
-            defQuery.addBindValue(QString::fromStdString(def.type));
-            defQuery.addBindValue(QString::fromStdString(def.content));
+            for (const auto& value : values) {
+                query->addBindValue(value);
+            }
+            query->addBindValue(english);
             
-            if (!defQuery.exec()) {
+            if (!query->exec()) {
+                throw std::runtime_error("Failed to update word");
+            }
+        }
+        
+        // Update definitions: keep matching rows, delete the ones that are
+        // gone and insert the new ones
+        std::vector<std::pair<std::string, std::string>> newDefinitions;
+        for (const auto& def : word.getDefinitions()) {
+            newDefinitions.emplace_back(def.type, def.content);
+        }
+        
+        std::vector<qlonglong> staleDefinitions;
+        auto defRows = cachedQuery(
+            "SELECT rowid, definition_type, content FROM word_definitions WHERE english = ?",
+            Access::Write
+        );
+        defRows->addBindValue(english);
+        if (!defRows->exec()) {
+            throw std::runtime_error("Failed to read word definitions");
+        }
+        while (defRows->next()) {
+            auto it = std::find(newDefinitions.begin(), newDefinitions.end(),
+                std::make_pair(defRows->value(1).toString().toStdString(),
+                               defRows->value(2).toString().toStdString()));
+            if (it != newDefinitions.end()) {
+                newDefinitions.erase(it);
+            } else {
+                staleDefinitions.push_back(defRows->value(0).toLongLong());
+            }
+        }
+        
+        auto delDefQuery = cachedQuery("DELETE FROM word_definitions WHERE rowid = ?", Access::Write);
+        for (qlonglong rowid : staleDefinitions) {
+            delDefQuery->addBindValue(rowid);
+            if (!delDefQuery->exec()) {
+                throw std::runtime_error("Failed to delete word definition");
+            }
+        }
+        
+        auto defQuery = cachedQuery(
+            "INSERT INTO word_definitions (english, definition_type, content) "
+            "VALUES (?, ?, ?)",
+            Access::Write
+        );
+        for (const auto& [type, content] : newDefinitions) {
+            defQuery->addBindValue(english);
+            defQuery->addBindValue(QString::fromStdString(type));
+            defQuery->addBindValue(QString::fromStdString(content));
+            
+            if (!defQuery->exec()) {
                 throw std::runtime_error("Failed to update word definition");
             }
         }
         
-        // Update categories (delete and re-insert)
-        QSqlQuery delCatQuery(db);
-        delCatQuery.prepare("DELETE FROM word_categories WHERE english = ?");
-        delCatQuery.addBindValue(QString::fromStdString(word.getEnglish()));
+        // Update categories the same way
+        std::vector<std::string> newCategories = word.getCategories();
+        std::vector<qlonglong> staleCategories;
+        auto catRows = cachedQuery(
+            "SELECT rowid, category FROM word_categories WHERE english = ?",
+            Access::Write
+        );
+        catRows->addBindValue(english);
+        if (!catRows->exec()) {
+            throw std::runtime_error("Failed to read word categories");
+        }
+        while (catRows->next()) {
+            auto it = std::find(newCategories.begin(), newCategories.end(),
+                                catRows->value(1).toString().toStdString());
+            if (it != newCategories.end()) {
+                newCategories.erase(it);
+            } else {
+                staleCategories.push_back(catRows->value(0).toLongLong());
+            }
+        }
         
-        if (!delCatQuery.exec()) {
-            throw std::runtime_error("Failed to delete word categories");
+        auto delCatQuery = cachedQuery("DELETE FROM word_categories WHERE rowid = ?", Access::Write);
+        for (qlonglong rowid : staleCategories) {
+            delCatQuery->addBindValue(rowid);
+            if (!delCatQuery->exec()) {
+                throw std::runtime_error("Failed to delete word category");
+            }
         }
         
-        for (const auto& category : word.getCategories()) {
-            QSqlQuery catQuery(db);
-            catQuery.prepare(
-                "INSERT INTO word_categories (english, category) VALUES (?, ?)"
-            );
-            catQuery.addBindValue(QString::fromStdString(word.getEnglish()));
-            catQuery.addBindValue(QString::fromStdString(category));
+        auto catQuery = cachedQuery(
+            "INSERT INTO word_categories (english, category) VALUES (?, ?)",
+            Access::Write
+        );
+        for (const auto& category : newCategories) {
+            catQuery->addBindValue(english);
+            catQuery->addBindValue(QString::fromStdString(category));
             
-            if (!catQuery.exec()) {
+            if (!catQuery->exec()) {
                 throw std::runtime_error("Failed to update word category");
             }
         }
         
-        db.commit();
-        return true;
+        return commitTransaction();
     } catch (const std::exception& e) {
-        db.rollback();
+        rollbackTransaction();
         qDebug() << "Error updating word: " << e.what();
         return false;
     }
 }
 
 bool WordRepository::remove(const std::string& english) {
-    db.transaction();
+    auto writeLock = lockWriter();
+    beginTransaction();
     
     try {
         // Delete from word_definitions
-        QSqlQuery delDefQuery(db);
-        delDefQuery.prepare("DELETE FROM word_definitions WHERE english = ?");
-        delDefQuery.addBindValue(QString::fromStdString(english));
+        auto delDefQuery = cachedQuery("DELETE FROM word_definitions WHERE english = ?", Access::Write);
+        delDefQuery->addBindValue(QString::fromStdString(english));
         
-        if (!delDefQuery.exec()) {
+        if (!delDefQuery->exec()) {
             throw std::runtime_error("Failed to delete word definitions");
         }
         
         // Delete from word_categories
-        QSqlQuery delCatQuery(db);
-        delCatQuery.prepare("DELETE FROM word_categories WHERE english = ?");
-        delCatQuery.addBindValue(QString::fromStdString(english));
+        auto delCatQuery = cachedQuery("DELETE FROM word_categories WHERE english = ?", Access::Write);
+        delCatQuery->addBindValue(QString::fromStdString(english));
         
-        if (!delCatQuery.exec()) {
+        if (!delCatQuery->exec()) {
             throw std::runtime_error("Failed to delete word categories");
         }
         
         // Delete from learning_records
-        QSqlQuery delLearningQuery(db);
-        delLearningQuery.prepare("DELETE FROM learning_records WHERE word = ?");
-        delLearningQuery.addBindValue(QString::fromStdString(english));
+        auto delLearningQuery = cachedQuery("DELETE FROM learning_records WHERE word = ?", Access::Write);
+        delLearningQuery->addBindValue(QString::fromStdString(english));
         
-        if (!delLearningQuery.exec()) {
+        if (!delLearningQuery->exec()) {
             throw std::runtime_error("Failed to delete learning records");
         }
         
         // Delete from words
-        QSqlQuery delWordQuery(db);
-        delWordQuery.prepare("DELETE FROM words WHERE english = ?");
-        delWordQuery.addBindValue(QString::fromStdString(english));
+        auto delWordQuery = cachedQuery("DELETE FROM words WHERE english = ?", Access::Write);
+        delWordQuery->addBindValue(QString::fromStdString(english));
         
-        if (!delWordQuery.exec()) {
+        if (!delWordQuery->exec()) {
             throw std::runtime_error("Failed to delete word");
         }
         
-        db.commit();
-        return true;
+        return commitTransaction();
     } catch (const std::exception& e) {
-        db.rollback();
+        rollbackTransaction();
         qDebug() << "Error removing word: " << e.what();
         return false;
     }
 }
 
+bool WordRepository::incrementStats(const std::string& english, int frequencyDelta,
+                                    int correctDelta, int attemptsDelta) {
+    auto writeLock = lockWriter();
+    auto query = cachedQuery(
+        "UPDATE words SET frequency = frequency + ?, correct_count = correct_count + ?, "
+        "total_attempts = total_attempts + ? WHERE english = ?",
+        Access::Write
+    );
+    query->addBindValue(frequencyDelta);
+    query->addBindValue(correctDelta);
+    query->addBindValue(attemptsDelta);
+    query->addBindValue(QString::fromStdString(english));
+    
+    if (!query->exec()) {
+        qDebug() << "Error updating word stats:" << query->lastError().text();
+        return false;
+    }
+    return query->numRowsAffected() > 0;
+}
+
+bool WordRepository::recordResults(const std::vector<ReviewResult>& results) {
+    if (results.empty()) return true;
+    
+    // Fold repeated answers for the same word into one delta
+    struct Delta {
+        int attempts = 0;
+        int correct = 0;
+    };
+    std::map<std::string, Delta> deltas;
+    std::set<std::string> missing;
+    for (const auto& result : results) {
+        auto& delta = deltas[result.english];
+        delta.attempts++;
+        if (result.correct) {
+            delta.correct++;
+        }
+    }
+    
+    auto writeLock = lockWriter();
+    beginTransaction();
+    
+    try {
+        auto query = cachedQuery(
+            "UPDATE words SET frequency = frequency + ?, correct_count = correct_count + ?, "
+            "total_attempts = total_attempts + ? WHERE english = ?",
+            Access::Write
+        );
+        for (const auto& [english, delta] : deltas) {
+            query->addBindValue(delta.attempts);
+            query->addBindValue(delta.correct);
+            query->addBindValue(delta.attempts);
+            query->addBindValue(QString::fromStdString(english));
+            
+            if (!query->exec()) {
+                throw std::runtime_error("Failed to record review result");
+            }
+            if (query->numRowsAffected() == 0) {
+                // Deleted while the session was running; nothing to update
+                qDebug() << "Skipping review result for missing word"
+                         << QString::fromStdString(english);
+                missing.insert(english);
+            }
+        }
+        
+        // Move each card to its next due date; a later answer for the same
+        // card overrides an earlier one
+        auto recordQuery = cachedQuery(
+            "INSERT INTO learning_records "
+            "(username, word, mastery_level, last_review_date, next_review_at, "
+            "stability, difficulty, reps, lapses, last_review_at) "
+            "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?) "
+            "ON CONFLICT(username, word) DO UPDATE SET "
+            "mastery_level = excluded.mastery_level, "
+            "last_review_date = excluded.last_review_date, "
+            "next_review_at = excluded.next_review_at, "
+            "stability = excluded.stability, "
+            "difficulty = excluded.difficulty, "
+            "reps = excluded.reps, "
+            "lapses = excluded.lapses, "
+            "last_review_at = excluded.last_review_at",
+            Access::Write
+        );
+        auto lastReviewQuery = cachedQuery(
+            "SELECT last_review_date FROM learning_records WHERE username = ? AND word = ?",
+            Access::Write
+        );
+        
+        // Results may be written well after they were given (the write-behind
+        // queue can hold them past midnight), so dates come from answeredAt
+        const auto flushedAt = std::chrono::system_clock::now();
+        auto answerTime = [flushedAt](const ReviewResult& result) {
+            return result.answeredAt.time_since_epoch().count() != 0
+                ? result.answeredAt : flushedAt;
+        };
+        
+        // Per-user totals for the rollup row of each local day answers were
+        // given on. wordsLearned counts distinct words, i.e. those not yet
+        // reviewed earlier that day.
+        struct Rollup {
+            int learned = 0;
+            int reviewed = 0;
+            int correct = 0;
+        };
+        std::map<std::pair<std::string, QString>, Rollup> rollups;
+        
+        for (const auto& result : results) {
+            if (result.username.empty() || missing.count(result.english)) continue;
+            
+            const QDateTime answeredAt = QDateTime::fromMSecsSinceEpoch(
+                std::chrono::duration_cast<std::chrono::milliseconds>(
+                    answerTime(result).time_since_epoch()).count());
+            const QDate day = answeredAt.date();
+            
+            lastReviewQuery->addBindValue(QString::fromStdString(result.username));
+            lastReviewQuery->addBindValue(QString::fromStdString(result.english));
+            if (!lastReviewQuery->exec()) {
+                throw std::runtime_error("Failed to read learning record");
+            }
+            bool reviewedThatDay = lastReviewQuery->next()
+                && lastReviewQuery->value(0).toDateTime().date() == day;
+            lastReviewQuery->finish();
+            
+            auto& rollup = rollups[{result.username, day.toString(Qt::ISODate)}];
+            rollup.reviewed++;
+            if (result.correct) {
+                rollup.correct++;
+            }
+            if (!reviewedThatDay) {
+                rollup.learned++;
+            }
+            
+            recordQuery->addBindValue(QString::fromStdString(result.username));
+            recordQuery->addBindValue(QString::fromStdString(result.english));
+            const CardState& card = result.card;
+            recordQuery->addBindValue(card.masteryLevel);
+            recordQuery->addBindValue(answeredAt.toString(Qt::ISODate));
+            recordQuery->addBindValue(static_cast<qint64>(card.nextReviewAt));
+            recordQuery->addBindValue(card.stability);
+            recordQuery->addBindValue(card.difficulty);
+            recordQuery->addBindValue(card.reps);
+            recordQuery->addBindValue(card.lapses);
+            recordQuery->addBindValue(static_cast<qint64>(card.lastReviewAt));
+            
+            if (!recordQuery->exec()) {
+                throw std::runtime_error("Failed to update learning record");
+            }
+        }
+        
+        // Append the answers to the attempts log; seq follows the user's
+        // answers already logged in the same second
+        auto attemptQuery = cachedQuery(
+            "INSERT INTO attempts "
+            "(username, attempted_at, seq, word_id, correct, response_ms) "
+            "SELECT ?, ?, (SELECT COUNT(*) FROM attempts WHERE username = ? "
+            "AND attempted_at = ?), id, ?, ? FROM words WHERE english = ?",
+            Access::Write
+        );
+        for (const auto& result : results) {
+            if (result.username.empty() || missing.count(result.english)) continue;
+            
+            const QString username = QString::fromStdString(result.username);
+            const qint64 attemptedAt = std::chrono::system_clock::to_time_t(answerTime(result));
+            attemptQuery->addBindValue(username);
+            attemptQuery->addBindValue(attemptedAt);
+            attemptQuery->addBindValue(username);
+            attemptQuery->addBindValue(attemptedAt);
+            attemptQuery->addBindValue(result.correct ? 1 : 0);
+            attemptQuery->addBindValue(static_cast<qint64>(result.responseTime.count()));
+            attemptQuery->addBindValue(QString::fromStdString(result.english));
+            
+            if (!attemptQuery->exec()) {
+                throw std::runtime_error("Failed to log attempt");
+            }
+        }
+        
+        auto rollupQuery = cachedQuery(
+            "INSERT INTO daily_rollups "
+            "(username, day, words_learned, words_reviewed, correct_count) "
+            "VALUES (?, ?, ?, ?, ?) "
+            "ON CONFLICT(username, day) DO UPDATE SET "
+            "words_learned = words_learned + excluded.words_learned, "
+            "words_reviewed = words_reviewed + excluded.words_reviewed, "
+            "correct_count = correct_count + excluded.correct_count",
+            Access::Write
+        );
+        for (const auto& [key, rollup] : rollups) {
+            rollupQuery->addBindValue(QString::fromStdString(key.first));
+            rollupQuery->addBindValue(key.second);
+            rollupQuery->addBindValue(rollup.learned);
+            rollupQuery->addBindValue(rollup.reviewed);
+            rollupQuery->addBindValue(rollup.correct);
+            
+            if (!rollupQuery->exec()) {
+                throw std::runtime_error("Failed to update daily rollup");
+            }
+        }
+        
+        return commitTransaction();
+    } catch (const std::exception& e) {
+        rollbackTransaction();
+        qDebug() << "Error recording review results: " << e.what();
+        return false;
+    }
+}
+
 std::vector<Word> WordRepository::getMostDifficultWords(int limit) {
     std::vector<Word> words;
-    QSqlQuery query(db);
+    QSqlQuery query(db());
     query.prepare(
         "SELECT * FROM words "
         "WHERE total_attempts > 0 "
@@ -300,12 +1099,7 @@ std::vector<Word> WordRepository::getMostDifficultWords(int limit) {
     query.addBindValue(limit);
     
     if (query.exec()) {
-        while (query.next()) {
-            auto word = findByEnglish(query.value("english").toString().toStdString());
-            if (word) {
-                words.push_back(*word);
-            }
-        }
+        words = hydrate(query);
     }
     
     return words;
@@ -313,25 +1107,20 @@ std::vector<Word> WordRepository::getMostDifficultWords(int limit) {
 
 std::vector<Word> WordRepository::getMostFrequentWords(int limit) {
     std::vector<Word> words;
-    QSqlQuery query(db);
+    QSqlQuery query(db());
     query.prepare("SELECT * FROM words ORDER BY frequency DESC LIMIT ?");
     query.addBindValue(limit);
     
     if (query.exec()) {
-        while (query.next()) {
-            auto word = findByEnglish(query.value("english").toString().toStdString());
-            if (word) {
-                words.push_back(*word);
-            }
-        }
+        words = hydrate(query);
     }
     
     return words;
 }
 
 std::vector<WordRepository::WordStats> WordRepository::getWordStats(const std::string& username) {
-    QSqlQuery query(db);
-    query.prepare("SELECT w.english, COUNT(a.id) as attempts, "
+    QSqlQuery query(db());
+    query.prepare("SELECT w.english, COUNT(a.word_id) as attempts, "
                  "SUM(CASE WHEN a.correct THEN 1 ELSE 0 END) as correct_count, "
                  "w.frequency "
                  "FROM words w "
@@ -355,33 +1144,30 @@ std::vector<WordRepository::WordStats> WordRepository::getWordStats(const std::s
 }
 
 std::vector<WordRepository::DailyStats> WordRepository::getDailyStats(
-    const std::string& username, 
-    const std::chrono::system_clock::time_point& date) {
-    
-    QSqlQuery query(db);
-    query.prepare("SELECT DATE(a.attempt_date) as date, "
-                 "COUNT(DISTINCT w.id) as words_learned, "
-                 "COUNT(a.id) as words_reviewed, "
-                 "AVG(CASE WHEN a.correct THEN 1 ELSE 0 END) as accuracy "
-                 "FROM attempts a "
-                 "JOIN words w ON w.id = a.word_id "
-                 "WHERE a.username = :username "
-                 "AND a.attempt_date >= :date "
-                 "GROUP BY DATE(a.attempt_date)");
-                 
-    query.bindValue(":username", QString::fromStdString(username));
-    query.bindValue(":date", QDateTime::fromSecsSinceEpoch(
-        std::chrono::system_clock::to_time_t(date)));
-    
+    const std::string& username, int days) {
     std::vector<DailyStats> stats;
-    if (query.exec()) {
-        while (query.next()) {
+    if (days <= 0) return stats;
+    
+    // The last `days` local days including today, newest first
+    auto query = cachedQuery(
+        "SELECT day, words_learned, words_reviewed, correct_count "
+        "FROM daily_rollups WHERE username = ? AND day >= ? "
+        "ORDER BY day DESC"
+    );
+    query->addBindValue(QString::fromStdString(username));
+    query->addBindValue(QDate::currentDate().addDays(1 - days).toString(Qt::ISODate));
+    
+    if (query->exec()) {
+        while (query->next()) {
             DailyStats stat;
+            QDate day = QDate::fromString(query->value("day").toString(), Qt::ISODate);
             stat.date = std::chrono::system_clock::from_time_t(
-                query.value("date").toDateTime().toSecsSinceEpoch());
-            stat.wordsLearned = query.value("words_learned").toInt();
-            stat.wordsReviewed = query.value("words_reviewed").toInt();
-            stat.accuracy = query.value("accuracy").toDouble();
+                QDateTime(day).toSecsSinceEpoch());
+            stat.wordsLearned = query->value("words_learned").toInt();
+            stat.wordsReviewed = query->value("words_reviewed").toInt();
+            stat.correctCount = query->value("correct_count").toInt();
+            stat.accuracy = stat.wordsReviewed > 0
+                ? static_cast<double>(stat.correctCount) / stat.wordsReviewed : 0.0;
             stats.push_back(stat);
         }
     }
@@ -389,16 +1175,14 @@ std::vector<WordRepository::DailyStats> WordRepository::getDailyStats(
 }
 
 std::map<std::string, int> WordRepository::getWordCountByCategory() {
-    QSqlQuery query(db);
-    query.prepare("SELECT category, COUNT(*) as count "
-                 "FROM word_categories "
-                 "GROUP BY category");
+    // Maintained by triggers on word_categories
+    auto query = cachedQuery("SELECT category, word_count FROM category_counts");
     
     std::map<std::string, int> counts;
-    if (query.exec()) {
-        while (query.next()) {
-            std::string category = query.value("category").toString().toStdString();
-            int count = query.value("count").toInt();
+    if (query->exec()) {
+        while (query->next()) {
+            std::string category = query->value("category").toString().toStdString();
+            int count = query->value("word_count").toInt();
             counts[category] = count;
         }
     }
@@ -406,8 +1190,8 @@ std::map<std::string, int> WordRepository::getWordCountByCategory() {
 }
 
 std::vector<WordRepository::WordStats> WordRepository::getMostReviewedWords(int limit) {
-    QSqlQuery query(db);
-    query.prepare("SELECT w.english, COUNT(a.id) as attempts, "
+    QSqlQuery query(db());
+    query.prepare("SELECT w.english, COUNT(a.word_id) as attempts, "
                  "SUM(CASE WHEN a.correct THEN 1 ELSE 0 END) as correct_count, "
                  "w.frequency "
                  "FROM words w "
@@ -433,31 +1217,111 @@ std::vector<WordRepository::WordStats> WordRepository::getMostReviewedWords(int
 }
 
 int WordRepository::getTotalReviewTime(const std::string& username) {
-    QSqlQuery query(db);
-    query.prepare("SELECT SUM(review_time_seconds) as total_time "
+    QSqlQuery query(db());
+    query.prepare("SELECT SUM(response_ms) as total_ms "
                  "FROM attempts "
                  "WHERE username = :username");
     query.bindValue(":username", QString::fromStdString(username));
     
     if (query.exec() && query.next()) {
-        return query.value("total_time").toInt();
+        return static_cast<int>(query.value("total_ms").toLongLong() / 1000);
+    }
+    return 0;
+}
+
+int WordRepository::countDueBefore(const std::string& username, int64_t time) {
+    auto query = cachedQuery(
+        "SELECT COUNT(*) FROM learning_records WHERE username = ? AND next_review_at <= ?");
+    query->addBindValue(QString::fromStdString(username));
+    query->addBindValue(static_cast<qint64>(time));
+    
+    if (query->exec() && query->next()) {
+        return query->value(0).toInt();
     }
     return 0;
 }
 
 std::vector<Word> WordRepository::getAllWords() {
     std::vector<Word> words;
-    QSqlQuery query(db);
-    query.prepare("SELECT english FROM words");
+    QSqlQuery query(db());
+    query.setForwardOnly(true);
+    query.prepare("SELECT * FROM words");
     
     if (query.exec()) {
         while (query.next()) {
-            auto word = findByEnglish(query.value(0).toString().toStdString());
-            if (word) {
-                words.push_back(*word);
+            words.push_back(readWordRow(query));
+        }
+        // Whole-table passes need no key filter at all.
+        loadDetails(words, QString(), {});
+    }
+    
+    return words;
+}
+
+std::vector<Word> WordRepository::findPageAfter(const std::string& after, int limit) {
+    std::vector<Word> words;
+    auto query = cachedQuery("SELECT * FROM words WHERE english > ? ORDER BY english LIMIT ?");
+    query->addBindValue(QString::fromStdString(after));
+    query->addBindValue(limit);
+    
+    if (query->exec()) {
+        while (query->next()) {
+            words.push_back(readWordRow(*query));
+        }
+    }
+    
+    return words;
+}
+
+std::vector<Word> WordRepository::findRowsByEnglish(const std::vector<std::string>& keys) {
+    return loadByKeys(keys, false);
+}
+
+std::vector<Word> WordRepository::getAllWordsWithCategories() {
+    std::vector<Word> words;
+    {
+        QSqlQuery query(db());
+        query.setForwardOnly(true);
+        query.prepare("SELECT * FROM words ORDER BY english");
+        if (query.exec()) {
+            while (query.next()) {
+                words.push_back(readWordRow(query));
+            }
+        }
+    }
+    
+    // Both scans run in english order, so categories merge in one pass
+    QSqlQuery query(db());
+    query.setForwardOnly(true);
+    query.prepare("SELECT english, category FROM word_categories "
+                  "WHERE category IS NOT NULL ORDER BY english");
+    if (query.exec()) {
+        size_t position = 0;
+        while (query.next()) {
+            std::string english = query.value(0).toString().toStdString();
+            while (position < words.size() && words[position].getEnglish() < english) {
+                position++;
+            }
+            if (position < words.size() && words[position].getEnglish() == english) {
+                words[position].addCategory(query.value(1).toString().toStdString());
             }
         }
     }
     
     return words;
 }
+
+std::vector<std::string> WordRepository::getAllHeadwords() {
+    std::vector<std::string> headwords;
+    QSqlQuery query(db());
+    query.setForwardOnly(true);
+    query.prepare("SELECT english FROM words");
+    
+    if (query.exec()) {
+        while (query.next()) {
+            headwords.push_back(query.value(0).toString().toStdString());
+        }
+    }
+    
+    return headwords;
+}
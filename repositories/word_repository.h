@@ -2,21 +2,82 @@
 #define WORD_REPOSITORY_H
 
 #include "base_repository.h"
+#include "../models/scheduler.h"
 #include "../models/word.h"
 #include <vector>
 #include <optional>
 #include <map>
+#include <set>
+#include <chrono>
+#include <utility>
 #include <QSqlQuery>
+#include <QVariant>
 
 class WordRepository : public BaseRepository {
 public:
     std::optional<Word> findByEnglish(const std::string& english);
     std::vector<Word> findByCategory(const std::string& category);
-    std::vector<Word> findDueForReview(const std::string& username, int limit = 10);
+    // Ranked full-text search over english, chinese and definitions. Every
+    // term of `text` matches as a prefix, for search-as-you-type.
+    std::vector<Word> search(const std::string& text, int limit = 50);
+    // Up to `limit` cards due for this user, topped up with words the user
+    // has never reviewed. Both come from index range scans with random
+    // sampling, not a sorted scan of the whole deck. Words in `exclude`
+    // (e.g. the session in progress) are skipped.
+    std::vector<Word> findDueForReview(const std::string& username, int limit = 10,
+                                       const std::set<std::string>& exclude = {});
+    // A session's words when the caller already knows which cards are due
+    // (see DueQueue): dueWords in order, then words the user has never
+    // reviewed up to `limit`
+    std::vector<Word> findReviewWords(const std::string& username,
+                                      const std::vector<std::string>& dueWords, int limit,
+                                      const std::set<std::string>& exclude = {});
+    // (word, next_review_at) of every card of the user
+    std::vector<std::pair<std::string, int64_t>> getReviewSchedule(const std::string& username);
+    // `count` distinct words drawn uniformly at random, optionally only
+    // from one category and/or part of speech (empty means any). Probes
+    // random ids in batches, so the cost follows `count` rather than the
+    // deck size; filters matching few words fall back to sampling their
+    // rows directly.
+    std::vector<Word> sampleRandomWords(int count, const std::string& category = {},
+                                        const std::string& partOfSpeech = {});
+    // Stored scheduling state of the given words the user has reviewed
+    std::map<std::string, CardState> getCardStates(const std::string& username,
+                                                   const std::vector<std::string>& words);
+    // Recomputes the due dates of all of the user's cards with engine and
+    // writes back the ones that moved. Reading and writing share one write
+    // transaction, so answers recorded meanwhile are not overwritten.
+    // changed receives the number of cards that moved.
+    bool rescheduleCards(const std::string& username, const SchedulerEngine& engine,
+                         int& changed);
     bool save(const Word& word);
+    // Writes the word's text, categories and definitions; its learning
+    // counters are only changed through incrementStats/recordResults
     bool update(const Word& word);
     bool remove(const std::string& english);
     
+    // Review results
+    struct ReviewResult {
+        std::string english;
+        bool correct;
+        // Scheduling state after the answer; the learning record is only
+        // written when username is set
+        std::string username;
+        CardState card;
+        // Logged to attempts when username is set
+        std::chrono::system_clock::time_point answeredAt;
+        std::chrono::milliseconds responseTime{0};
+    };
+    
+    // Applies counter deltas in a single UPDATE without reading the word
+    // first. Returns false if the word does not exist.
+    bool incrementStats(const std::string& english, int frequencyDelta,
+                        int correctDelta, int attemptsDelta);
+    // Persists a batch of answers in one transaction: one UPDATE per word,
+    // the learning record of every answered card and one attempts log row
+    // per answer.
+    bool recordResults(const std::vector<ReviewResult>& results);
+    
     // Statistics
     int getTotalWordCount();
     std::vector<Word> getMostDifficultWords(int limit = 10);
@@ -33,19 +94,44 @@ public:
     
     struct DailyStats {
         std::chrono::system_clock::time_point date;
-        int wordsLearned;
-        int wordsReviewed;
+        int wordsLearned;   // Distinct words reviewed that day
+        int wordsReviewed;  // Answers given that day
+        int correctCount;
         double accuracy;
     };
     
     std::vector<WordStats> getWordStats(const std::string& username);
-    std::vector<DailyStats> getDailyStats(const std::string& username, const std::chrono::system_clock::time_point& date);
+    // One entry per active day in the last `days` days, newest first
+    std::vector<DailyStats> getDailyStats(const std::string& username, int days);
     std::map<std::string, int> getWordCountByCategory();
     std::vector<WordStats> getMostReviewedWords(int limit = 10);
-    int getTotalReviewTime(const std::string& username);
+    int getTotalReviewTime(const std::string& username);  // in seconds
+    // Cards due at or before `time` (epoch seconds)
+    int countDueBefore(const std::string& username, int64_t time);
     
     // Add this method to retrieve all words
     std::vector<Word> getAllWords();
+    std::vector<std::string> getAllHeadwords();
+
+    // Word rows without definitions or categories, for list views.
+    // findPageAfter pages through the deck in english order (keyset
+    // pagination on the primary key); findRowsByEnglish keeps key order.
+    std::vector<Word> findPageAfter(const std::string& after, int limit);
+    std::vector<Word> findRowsByEnglish(const std::vector<std::string>& keys);
+    // Every word with its categories but without definitions, in english order
+    std::vector<Word> getAllWordsWithCategories();
+
+private:
+    // Batched hydration: builds words from a result set over `words` rows and
+    // then loads their definitions and categories with set-based queries, so
+    // bulk readers cost a fixed number of queries instead of 3 per word.
+    std::vector<Word> hydrate(QSqlQuery& query);
+    void loadDetails(std::vector<Word>& words);
+    std::vector<Word> loadByKeys(const std::vector<std::string>& keys, bool withDetails = true);
+    // Appends up to `missing` words the user has never reviewed to keys
+    void appendNewWords(const std::string& username, int missing,
+                        const std::set<std::string>& exclude, std::vector<std::string>& keys);
+    void loadDetails(std::vector<Word>& words, const QString& scope, const QVariantList& binds);
 };
 
 #endif // WORD_REPOSITORY_H
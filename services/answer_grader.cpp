@@ -0,0 +1,184 @@
+#include "answer_grader.h"
+#include "edit_distance.h"
+#include <algorithm>
+
+namespace {
+    constexpr char32_t kReplacement = 0xFFFD;
+
+    // Decodes the code point at pos and moves pos past it. Malformed
+    // sequences decode as U+FFFD one byte at a time.
+    char32_t nextCodePoint(const std::string& text, size_t& pos) {
+        const auto* bytes = reinterpret_cast<const unsigned char*>(text.data());
+        unsigned char lead = bytes[pos++];
+        if (lead < 0x80) return lead;
+
+        size_t length = lead >= 0xF0 ? 3 : lead >= 0xE0 ? 2 : 1;
+        if (lead < 0xC2 || lead > 0xF4 || pos + length > text.size()) return kReplacement;
+        char32_t value = lead & (0x3F >> length);
+        for (size_t i = 0; i < length; ++i) {
+            unsigned char next = bytes[pos + i];
+            if ((next & 0xC0) != 0x80) return kReplacement;
+            value = (value << 6) | (next & 0x3F);
+        }
+        pos += length;
+        return value;
+    }
+
+    // Full-width ASCII and the ideographic space to ASCII, then lowercase
+    char32_t fold(char32_t c) {
+        if (c >= 0xFF01 && c <= 0xFF5E) c -= 0xFEE0;
+        if (c == 0x3000) c = U' ';
+        if (c >= U'A' && c <= U'Z') c += U'a' - U'A';
+        return c;
+    }
+
+    // Expects folded code points
+    bool isSeparator(char32_t c) {
+        return c == U';' || c == U',' || c == U'/' || c == U'\n' || c == 0x3001;
+    }
+
+    bool isOpenBracket(char32_t c) {
+        return c == U'(' || c == U'[' || c == 0x3010 || c == 0x3014;
+    }
+
+    bool isCloseBracket(char32_t c) {
+        return c == U')' || c == U']' || c == 0x3011 || c == 0x3015;
+    }
+
+    // Whitespace, controls and punctuation never count towards a distance.
+    // Expects folded code points.
+    bool isIgnored(char32_t c) {
+        if (c <= U' ' || c == 0x7F) return true;
+        if (c < 0x80) {
+            return !((c >= U'0' && c <= U'9') || (c >= U'a' && c <= U'z'));
+        }
+        return c == 0xB7                        // Middle dot
+            || (c >= 0x2000 && c <= 0x206F)     // General punctuation
+            || (c >= 0x3000 && c <= 0x303F)     // CJK symbols and punctuation
+            || (c >= 0xFE30 && c <= 0xFE4F);    // CJK compatibility forms
+    }
+
+    std::string trimmed(const std::string& text, size_t begin, size_t end) {
+        const char* const spaces = " \t\r\n";
+        begin = text.find_first_not_of(spaces, begin);
+        if (begin == std::string::npos || begin >= end) return {};
+        return text.substr(begin, text.find_last_not_of(spaces, end - 1) - begin + 1);
+    }
+}
+
+AnswerGrader::AnswerGrader(double acceptScore) : acceptScore(acceptScore) {}
+
+AnswerGrader::AnswerKey AnswerGrader::prepare(const std::string& expected) {
+    AnswerKey key;
+    key.expected = expected;
+    key.normalized.reserve(expected.size());
+
+    // One pass: split at top-level separators, normalizing as we go.
+    // Meanings with nothing left after normalizing are dropped.
+    AnswerKey::Meaning current{0, 0, 0, 0};
+    int depth = 0;
+    auto cut = [&](size_t end) {
+        current.normalizedEnd = key.normalized.size();
+        if (current.normalizedEnd > current.normalizedBegin) {
+            current.end = end;
+            key.meanings.push_back(current);
+        }
+    };
+    for (size_t pos = 0; pos < expected.size();) {
+        size_t at = pos;
+        char32_t c = fold(nextCodePoint(expected, pos));
+        if (isOpenBracket(c)) {
+            depth++;
+        } else if (isCloseBracket(c)) {
+            depth = std::max(depth - 1, 0);
+        } else if (depth == 0 && isSeparator(c)) {
+            cut(at);
+            current = {pos, pos, key.normalized.size(), key.normalized.size()};
+        } else if (depth == 0 && !isIgnored(c)) {
+            key.normalized.push_back(c);
+        }
+    }
+    cut(expected.size());
+
+    // Every meaning typed out in order
+    if (key.meanings.size() > 1) {
+        key.meanings.push_back({0, expected.size(), 0, key.normalized.size()});
+    }
+    return key;
+}
+
+AnswerGrader::Grade AnswerGrader::grade(const std::string& answer,
+                                        const AnswerKey& key) const {
+    Grade best;
+    const std::u32string typed = normalize(answer);
+    if (typed.empty()) return best;
+
+    const bool bitParallel = typed.size() <= MyersPattern<char32_t>::kMaxLength;
+    const MyersPattern<char32_t> matcher(bitParallel ? typed : std::u32string());
+    const AnswerKey::Meaning* bestMeaning = nullptr;
+    for (const auto& meaning : key.meanings) {
+        size_t length = meaning.normalizedEnd - meaning.normalizedBegin;
+        size_t longest = std::max(typed.size(), length);
+        // The length difference alone may already rule the meaning out
+        size_t gap = longest - std::min(typed.size(), length);
+        if (bestMeaning && 1.0 - static_cast<double>(gap) / longest <= best.score) continue;
+
+        const char32_t* target = key.normalized.data() + meaning.normalizedBegin;
+        size_t distance = bitParallel
+            ? matcher.distance(target, length)
+            : editDistance(typed, std::u32string(target, length));
+        double score = 1.0 - static_cast<double>(distance) / longest;
+        if (!bestMeaning || score > best.score) {
+            bestMeaning = &meaning;
+            best.score = score;
+            best.distance = distance;
+            if (distance == 0) break;
+        }
+    }
+
+    if (bestMeaning) {
+        best.matched = trimmed(key.expected, bestMeaning->begin, bestMeaning->end);
+        best.correct = best.score >= acceptScore;
+    }
+    return best;
+}
+
+AnswerGrader::Grade AnswerGrader::grade(const std::string& answer,
+                                        const std::string& expected) const {
+    return grade(answer, prepare(expected));
+}
+
+std::vector<std::string> AnswerGrader::splitMeanings(const std::string& expected) {
+    AnswerKey key = prepare(expected);
+    // The last entry of several is the whole text
+    if (key.meanings.size() > 1) {
+        key.meanings.pop_back();
+    }
+    std::vector<std::string> meanings;
+    for (const auto& meaning : key.meanings) {
+        meanings.push_back(trimmed(expected, meaning.begin, meaning.end));
+    }
+    return meanings;
+}
+
+std::u32string AnswerGrader::normalize(const std::string& text) {
+    std::u32string normalized;
+    normalized.reserve(text.size());
+    int depth = 0;
+    for (size_t pos = 0; pos < text.size();) {
+        char32_t c = fold(nextCodePoint(text, pos));
+        // Bracketed notes such as "（口语）" are not part of the answer
+        if (isOpenBracket(c)) {
+            depth++;
+        } else if (isCloseBracket(c)) {
+            depth = std::max(depth - 1, 0);
+        } else if (depth == 0 && !isIgnored(c)) {
+            normalized.push_back(c);
+        }
+    }
+    return normalized;
+}
+
+size_t AnswerGrader::editDistance(const std::u32string& a, const std::u32string& b) {
+    return ::editDistance(a, b);
+}
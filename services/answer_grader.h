@@ -0,0 +1,56 @@
+#ifndef ANSWER_GRADER_H
+#define ANSWER_GRADER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Typo-tolerant grading of typed answers. The expected text is split into
+// its meanings (on ；;，,、/ outside brackets) and the answer is accepted
+// if it is close enough to any one of them, or to all of them typed in
+// order. Both sides are compared as normalized code points: full-width
+// forms folded, ASCII lowercased, bracketed notes, spaces and punctuation
+// dropped.
+//
+// Distances use Myers' bit-parallel algorithm with the answer as the
+// pattern, so each meaning costs one pass of word operations per code
+// point. prepare() parses the expected text once per word, leaving only
+// those passes for each answer. Stateless and thread-safe.
+class AnswerGrader {
+public:
+    struct Grade {
+        bool correct = false;
+        double score = 0.0;     // 1 - distance / longer length, best meaning
+        size_t distance = 0;    // Edits to the best meaning
+        std::string matched;    // Best meaning as written in the expected text
+    };
+
+    // The expected text parsed once, for grading several answers to it
+    struct AnswerKey {
+        struct Meaning {
+            size_t begin, end;                      // Bytes of `expected`
+            size_t normalizedBegin, normalizedEnd;  // Code points of `normalized`
+        };
+
+        std::string expected;
+        std::u32string normalized;      // All meanings, back to back
+        std::vector<Meaning> meanings;
+    };
+
+    // Answers scoring at least `acceptScore` count as correct
+    explicit AnswerGrader(double acceptScore = 0.75);
+
+    static AnswerKey prepare(const std::string& expected);
+    Grade grade(const std::string& answer, const AnswerKey& key) const;
+    Grade grade(const std::string& answer, const std::string& expected) const;
+
+    // The meanings of `expected` as they are written, trimmed
+    static std::vector<std::string> splitMeanings(const std::string& expected);
+    static std::u32string normalize(const std::string& text);
+    static size_t editDistance(const std::u32string& a, const std::u32string& b);
+
+private:
+    double acceptScore;
+};
+
+#endif // ANSWER_GRADER_H
@@ -0,0 +1,78 @@
+#ifndef ASYNC_TASK_H
+#define ASYNC_TASK_H
+
+#include "../repositories/connection_pool.h"
+#include <QDebug>
+#include <QException>
+#include <QFuture>
+#include <QFutureWatcher>
+#include <QObject>
+#include <QString>
+#include <QtConcurrent/QtConcurrentRun>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+// Helpers behind the services' *Async methods. Work runs on the connection
+// pool's reader threads, each of which has its own read-only connection;
+// results come back to the GUI thread through whenFinished().
+
+// A std::exception thrown by a service call, carried across threads.
+// QtConcurrent only transports QException subclasses.
+class AsyncError : public QException {
+public:
+    explicit AsyncError(std::string message) : message(std::move(message)) {}
+
+    const char* what() const noexcept override { return message.c_str(); }
+    void raise() const override { throw *this; }
+    AsyncError* clone() const override { return new AsyncError(*this); }
+
+private:
+    std::string message;
+};
+
+template <typename Fn>
+auto runOnReaders(Fn fn) -> QFuture<decltype(fn())> {
+    return QtConcurrent::run(ConnectionPool::instance().readerThreads(), [fn]() {
+        try {
+            return fn();
+        } catch (const QException&) {
+            throw;
+        } catch (const std::exception& e) {
+            throw AsyncError(e.what());
+        }
+    });
+}
+
+// Calls onResult with the result on context's thread once the future is
+// ready, or onError with the message if the task or onResult threw. An
+// exception never escapes into the event loop: without onError it is
+// logged. Nothing is called if context is destroyed first.
+template <typename T, typename OnResult>
+void whenFinished(QObject* context, const QFuture<T>& future, OnResult onResult,
+                  std::function<void(const QString&)> onError = {}) {
+    auto* watcher = new QFutureWatcher<T>(context);
+    QObject::connect(watcher, &QFutureWatcherBase::finished, context,
+        [watcher, onResult, onError]() {
+            watcher->deleteLater();
+            QString message;
+            try {
+                onResult(watcher->result());
+                return;
+            } catch (const std::exception& e) {
+                // AsyncError, QUnhandledException and whatever onResult throws
+                message = QString::fromUtf8(e.what());
+            } catch (...) {
+                message = QStringLiteral("Unknown error");
+            }
+            if (onError) {
+                onError(message);
+            } else {
+                qWarning() << "Unhandled error in async task:" << message;
+            }
+        });
+    watcher->setFuture(future);
+}
+
+#endif // ASYNC_TASK_H
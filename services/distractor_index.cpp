@@ -0,0 +1,324 @@
+#include "distractor_index.h"
+#include <QtConcurrent/QtConcurrentMap>
+#include <algorithm>
+#include <cctype>
+#include <numeric>
+#include <random>
+#include <tuple>
+#include <utility>
+
+namespace {
+    // Neighbours on each side, in each sort order, scored per word
+    constexpr size_t kWindow = 32;
+    // Look-alikes must share at least this much of their spelling
+    constexpr double kMinSimilarity = 0.5;
+    // Tie-breaker towards words of the same part of speech
+    constexpr double kSamePartOfSpeechBonus = 0.15;
+    // Random picks per bucket before moving on to a wider one
+    constexpr int kProbes = 16;
+
+    std::string fold(const std::string& text) {
+        std::string folded(text);
+        for (auto& c : folded) {
+            auto byte = static_cast<unsigned char>(c);
+            if (byte < 0x80) {
+                c = static_cast<char>(std::tolower(byte));
+            }
+        }
+        return folded;
+    }
+
+    std::mt19937& randomEngine() {
+        thread_local std::mt19937 engine{std::random_device{}()};
+        return engine;
+    }
+}
+
+void DistractorIndex::build(std::vector<Entry> entries) {
+    nodes.clear();
+    byEnglish.clear();
+    forwardOrder.clear();
+    reverseOrder.clear();
+    byPartOfSpeech.clear();
+    byCategory.clear();
+
+    // Ids follow spelling order, so the forward window of every word is a
+    // contiguous run of nodes
+    std::vector<std::pair<std::string, size_t>> keys;
+    keys.reserve(entries.size());
+    for (size_t i = 0; i < entries.size(); ++i) {
+        keys.emplace_back(fold(entries[i].english), i);
+    }
+    std::sort(keys.begin(), keys.end());
+
+    nodes.reserve(entries.size());
+    byEnglish.reserve(entries.size());
+    for (auto& [key, index] : keys) {
+        Entry& entry = entries[index];
+        if (byEnglish.count(entry.english)) continue;
+
+        Node node;
+        node.key = std::move(key);
+        node.reversedKey.assign(node.key.rbegin(), node.key.rend());
+        node.entry = std::move(entry);
+        byEnglish.emplace(node.entry.english, static_cast<Id>(nodes.size()));
+        nodes.push_back(std::move(node));
+    }
+
+    std::vector<Id> ids(nodes.size());
+    std::iota(ids.begin(), ids.end(), 0);
+    forwardOrder = ids;
+    reverseOrder = ids;
+    std::sort(reverseOrder.begin(), reverseOrder.end(), [this](Id a, Id b) {
+        return std::tie(nodes[a].reversedKey, a) < std::tie(nodes[b].reversedKey, b);
+    });
+    for (Id id : ids) {
+        addToBuckets(id);
+    }
+
+    // Each word only writes its own neighbour list
+    QtConcurrent::blockingMap(ids, [this](Id id) { computeNeighbors(id); });
+}
+
+void DistractorIndex::insert(Entry entry) {
+    remove(entry.english);
+
+    Id id = static_cast<Id>(nodes.size());
+    Node node;
+    node.key = fold(entry.english);
+    node.reversedKey.assign(node.key.rbegin(), node.key.rend());
+    node.entry = std::move(entry);
+    byEnglish.emplace(node.entry.english, id);
+    nodes.push_back(std::move(node));
+
+    auto forward = std::lower_bound(forwardOrder.begin(), forwardOrder.end(), id,
+        [this](Id a, Id b) { return std::tie(nodes[a].key, a) < std::tie(nodes[b].key, b); });
+    forwardOrder.insert(forward, id);
+    auto reverse = std::lower_bound(reverseOrder.begin(), reverseOrder.end(), id,
+        [this](Id a, Id b) {
+            return std::tie(nodes[a].reversedKey, a) < std::tie(nodes[b].reversedKey, b);
+        });
+    reverseOrder.insert(reverse, id);
+    addToBuckets(id);
+
+    computeNeighbors(id);
+    for (Id candidate : candidatesFor(id)) {
+        offerNeighbor(candidate, id);
+    }
+}
+
+bool DistractorIndex::remove(const std::string& english) {
+    auto it = byEnglish.find(english);
+    if (it == byEnglish.end()) return false;
+    Id id = it->second;
+
+    // Words near it in either order are the ones likely to list it
+    std::vector<Id> affected = candidatesFor(id);
+
+    auto forward = std::lower_bound(forwardOrder.begin(), forwardOrder.end(), id,
+        [this](Id a, Id b) { return std::tie(nodes[a].key, a) < std::tie(nodes[b].key, b); });
+    forwardOrder.erase(forward);
+    auto reverse = std::lower_bound(reverseOrder.begin(), reverseOrder.end(), id,
+        [this](Id a, Id b) {
+            return std::tie(nodes[a].reversedKey, a) < std::tie(nodes[b].reversedKey, b);
+        });
+    reverseOrder.erase(reverse);
+    removeFromBuckets(id);
+    byEnglish.erase(it);
+
+    // The slot stays as a tombstone so ids remain stable; a rebuild at the
+    // next login reclaims it
+    Node& node = nodes[id];
+    node.alive = false;
+    node.neighbors.clear();
+    node.neighbors.shrink_to_fit();
+
+    for (Id other : affected) {
+        const auto& list = nodes[other].neighbors;
+        if (std::find(list.begin(), list.end(), id) != list.end()) {
+            computeNeighbors(other);
+        }
+    }
+    return true;
+}
+
+std::vector<DistractorIndex::Entry> DistractorIndex::distractorsFor(const std::string& english,
+                                                                    size_t count) const {
+    std::vector<Entry> out;
+    auto it = byEnglish.find(english);
+    if (it == byEnglish.end() || count == 0) return out;
+
+    const Id self = it->second;
+    const Entry& answer = nodes[self].entry;
+    std::vector<Id> chosen;
+    auto take = [&](Id other) {
+        if (chosen.size() >= count || other == self || !nodes[other].alive) return;
+        if (nodes[other].entry.chinese == answer.chinese) return;
+        if (std::find(chosen.begin(), chosen.end(), other) != chosen.end()) return;
+        chosen.push_back(other);
+    };
+    auto& rng = randomEngine();
+    auto probe = [&](const std::vector<Id>& bucket, auto accept) {
+        if (bucket.empty()) return;
+        std::uniform_int_distribution<size_t> pick(0, bucket.size() - 1);
+        for (int i = 0; i < kProbes && chosen.size() < count; ++i) {
+            Id other = bucket[pick(rng)];
+            if (accept(other)) {
+                take(other);
+            }
+        }
+    };
+    auto samePartOfSpeech = [&](Id other) {
+        return nodes[other].entry.partOfSpeech == answer.partOfSpeech;
+    };
+    auto anyWord = [](Id) { return true; };
+
+    // The closest look-alikes, shuffled among twice as many as needed so
+    // repeated questions vary. One slot is left for a word that is
+    // confusable in meaning rather than spelling.
+    size_t lookAlikeSlots = count > 1 ? count - 1 : count;
+    std::vector<Id> lookAlikes = nodes[self].neighbors;
+    std::shuffle(lookAlikes.begin(),
+                 lookAlikes.begin() + std::min(lookAlikes.size(), 2 * lookAlikeSlots), rng);
+    for (Id other : lookAlikes) {
+        if (chosen.size() >= lookAlikeSlots) break;
+        take(other);
+    }
+
+    if (!answer.categories.empty()) {
+        std::uniform_int_distribution<size_t> pickCategory(0, answer.categories.size() - 1);
+        auto bucket = byCategory.find(answer.categories[pickCategory(rng)]);
+        if (bucket != byCategory.end()) {
+            probe(bucket->second, samePartOfSpeech);
+        }
+    }
+    auto partOfSpeech = byPartOfSpeech.find(answer.partOfSpeech);
+    if (partOfSpeech != byPartOfSpeech.end()) {
+        probe(partOfSpeech->second, anyWord);
+    }
+    probe(forwardOrder, anyWord);
+    for (Id other : lookAlikes) {
+        take(other);
+    }
+
+    out.reserve(chosen.size());
+    for (Id id : chosen) {
+        out.push_back(nodes[id].entry);
+    }
+    return out;
+}
+
+std::vector<DistractorIndex::Id> DistractorIndex::candidatesFor(Id id) const {
+    std::vector<Id> candidates;
+    candidates.reserve(4 * kWindow);
+
+    auto collect = [&](const std::vector<Id>& order, auto less) {
+        auto at = std::lower_bound(order.begin(), order.end(), id, less);
+        size_t position = static_cast<size_t>(at - order.begin());
+        size_t begin = position > kWindow ? position - kWindow : 0;
+        size_t end = std::min(order.size(), position + kWindow + 1);
+        for (size_t i = begin; i < end; ++i) {
+            if (order[i] != id) {
+                candidates.push_back(order[i]);
+            }
+        }
+    };
+    collect(forwardOrder, [this](Id a, Id b) {
+        return std::tie(nodes[a].key, a) < std::tie(nodes[b].key, b);
+    });
+    collect(reverseOrder, [this](Id a, Id b) {
+        return std::tie(nodes[a].reversedKey, a) < std::tie(nodes[b].reversedKey, b);
+    });
+    return candidates;
+}
+
+void DistractorIndex::computeNeighbors(Id id) {
+    // One pattern for all of the word's candidates
+    const std::string& key = nodes[id].key;
+    const bool bitParallel = key.size() <= MyersPattern<char>::kMaxLength;
+    const MyersPattern<char> pattern(bitParallel ? key : std::string());
+    
+    std::vector<std::pair<double, Id>> scored;
+    for (Id candidate : candidatesFor(id)) {
+        double score = similarity(id, candidate, bitParallel ? &pattern : nullptr);
+        if (score >= kMinSimilarity) {
+            scored.emplace_back(score, candidate);
+        }
+    }
+    std::sort(scored.begin(), scored.end(), [](const auto& a, const auto& b) {
+        return a.first != b.first ? a.first > b.first : a.second < b.second;
+    });
+    scored.erase(std::unique(scored.begin(), scored.end()), scored.end());
+
+    auto& neighbors = nodes[id].neighbors;
+    neighbors.clear();
+    for (const auto& [score, candidate] : scored) {
+        if (neighbors.size() >= kNeighbors) break;
+        neighbors.push_back(candidate);
+    }
+}
+
+void DistractorIndex::offerNeighbor(Id id, Id candidate) {
+    double score = similarity(id, candidate);
+    if (score < kMinSimilarity) return;
+
+    auto& neighbors = nodes[id].neighbors;
+    if (std::find(neighbors.begin(), neighbors.end(), candidate) != neighbors.end()) return;
+    if (neighbors.size() >= kNeighbors && similarity(id, neighbors.back()) >= score) return;
+
+    // Lists are short; keep them best-first by re-inserting in place
+    auto slot = std::find_if(neighbors.begin(), neighbors.end(),
+        [&](Id other) { return similarity(id, other) < score; });
+    neighbors.insert(slot, candidate);
+    if (neighbors.size() > kNeighbors) {
+        neighbors.pop_back();
+    }
+}
+
+double DistractorIndex::similarity(Id a, Id b, const MyersPattern<char>* pattern) const {
+    const Node& left = nodes[a];
+    const Node& right = nodes[b];
+    // Same meaning is no use as a wrong answer
+    if (left.entry.chinese == right.entry.chinese) return 0.0;
+
+    size_t longest = std::max(left.key.size(), right.key.size());
+    if (longest == 0) return 0.0;
+    size_t distance = pattern ? pattern->distance(right.key) : editDistance(left.key, right.key);
+    double score = 1.0 - static_cast<double>(distance) / longest;
+    if (!left.entry.partOfSpeech.empty()
+        && left.entry.partOfSpeech == right.entry.partOfSpeech) {
+        score += kSamePartOfSpeechBonus;
+    }
+    return score;
+}
+
+void DistractorIndex::addToBuckets(Id id) {
+    const Entry& entry = nodes[id].entry;
+    byPartOfSpeech[entry.partOfSpeech].push_back(id);
+    for (const auto& category : entry.categories) {
+        byCategory[category].push_back(id);
+    }
+}
+
+void DistractorIndex::removeFromBuckets(Id id) {
+    auto erase = [id](std::unordered_map<std::string, std::vector<Id>>& buckets,
+                      const std::string& key) {
+        auto bucket = buckets.find(key);
+        if (bucket == buckets.end()) return;
+        auto& ids = bucket->second;
+        auto at = std::find(ids.begin(), ids.end(), id);
+        if (at != ids.end()) {
+            *at = ids.back();
+            ids.pop_back();
+        }
+        if (ids.empty()) {
+            buckets.erase(bucket);
+        }
+    };
+
+    const Entry& entry = nodes[id].entry;
+    erase(byPartOfSpeech, entry.partOfSpeech);
+    for (const auto& category : entry.categories) {
+        erase(byCategory, category);
+    }
+}
@@ -0,0 +1,73 @@
+#ifndef DISTRACTOR_INDEX_H
+#define DISTRACTOR_INDEX_H
+
+#include "edit_distance.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Precomputed wrong answers for multiple-choice questions. Every word keeps
+// a short list of its most similarly spelled words, found among its
+// neighbours in forward and reversed alphabetical order (shared prefixes
+// and shared endings). Words are also bucketed by part of speech and by
+// category, so a question's options take a fixed number of lookups no
+// matter how large the deck is.
+//
+// build() spreads the neighbour search over all cores; insert() and
+// remove() keep the index current afterwards. Not thread-safe: owned by
+// WordService and used from the GUI thread once built.
+class DistractorIndex {
+public:
+    struct Entry {
+        std::string english;
+        std::string partOfSpeech;
+        std::string chinese;
+        std::vector<std::string> categories;
+    };
+
+    // Orthographic neighbours kept per word
+    static constexpr size_t kNeighbors = 8;
+
+    void build(std::vector<Entry> entries);
+    // Adds the word, or replaces it if it is already indexed
+    void insert(Entry entry);
+    bool remove(const std::string& english);
+
+    size_t size() const { return byEnglish.size(); }
+
+    // Up to `count` other words to offer next to `english`, best first:
+    // look-alike spellings, then words sharing its part of speech and a
+    // category, then its part of speech, then any word. Words whose Chinese
+    // matches the correct answer are never offered.
+    std::vector<Entry> distractorsFor(const std::string& english, size_t count) const;
+
+private:
+    using Id = uint32_t;
+
+    struct Node {
+        Entry entry;
+        std::string key;          // Folded english
+        std::string reversedKey;  // key back to front, to group shared endings
+        std::vector<Id> neighbors;
+        bool alive = true;
+    };
+
+    std::vector<Id> candidatesFor(Id id) const;
+    void computeNeighbors(Id id);
+    void offerNeighbor(Id id, Id candidate);
+    // pattern, if given, is a MyersPattern of a's key
+    double similarity(Id a, Id b, const MyersPattern<char>* pattern = nullptr) const;
+    void addToBuckets(Id id);
+    void removeFromBuckets(Id id);
+
+    std::vector<Node> nodes;
+    std::unordered_map<std::string, Id> byEnglish;
+    std::vector<Id> forwardOrder;    // Live ids sorted by key
+    std::vector<Id> reverseOrder;    // Live ids sorted by reversedKey
+    std::unordered_map<std::string, std::vector<Id>> byPartOfSpeech;
+    std::unordered_map<std::string, std::vector<Id>> byCategory;
+};
+
+#endif // DISTRACTOR_INDEX_H
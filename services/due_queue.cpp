@@ -0,0 +1,161 @@
+#include "due_queue.h"
+#include <functional>
+#include <queue>
+#include <utility>
+
+void DueQueue::load(const std::string& user, std::vector<Entry> entries) {
+    std::lock_guard<std::mutex> lock(mutex);
+    username = user;
+    heap = std::move(entries);
+    positions.clear();
+    positions.reserve(heap.size());
+
+    // Keep the last due time of a repeated word
+    size_t kept = 0;
+    for (size_t i = 0; i < heap.size(); ++i) {
+        auto [slot, inserted] = positions.emplace(heap[i].word, kept);
+        if (!inserted) {
+            heap[slot->second].dueAt = heap[i].dueAt;
+            continue;
+        }
+        if (kept != i) {
+            heap[kept] = std::move(heap[i]);
+        }
+        kept++;
+    }
+    heap.resize(kept);
+
+    // Bottom-up heapify
+    for (size_t i = heap.size() / 2; i-- > 0;) {
+        siftDown(i);
+    }
+}
+
+void DueQueue::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    username.clear();
+    heap.clear();
+    positions.clear();
+}
+
+std::string DueQueue::getUsername() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return username;
+}
+
+size_t DueQueue::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return heap.size();
+}
+
+void DueQueue::update(const std::string& word, int64_t dueAt) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = positions.find(word);
+    if (it == positions.end()) {
+        heap.push_back({word, dueAt});
+        positions.emplace(word, heap.size() - 1);
+        siftUp(heap.size() - 1);
+        return;
+    }
+
+    size_t index = it->second;
+    int64_t previous = heap[index].dueAt;
+    heap[index].dueAt = dueAt;
+    if (dueAt < previous) {
+        siftUp(index);
+    } else {
+        siftDown(index);
+    }
+}
+
+bool DueQueue::remove(const std::string& word) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = positions.find(word);
+    if (it == positions.end()) return false;
+
+    size_t index = it->second;
+    size_t last = heap.size() - 1;
+    if (index != last) {
+        swapEntries(index, last);
+    }
+    positions.erase(heap.back().word);
+    heap.pop_back();
+
+    if (index < heap.size()) {
+        siftDown(index);
+        siftUp(index);
+    }
+    return true;
+}
+
+std::vector<DueQueue::Entry> DueQueue::nextDue(size_t k, int64_t time) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<Entry> due;
+    if (k == 0 || heap.empty() || heap[0].dueAt > time) return due;
+
+    // Walk the heap best-first: a node's children only become candidates
+    // once it is taken, so at most 2k nodes are ever looked at
+    using Candidate = std::pair<int64_t, size_t>;
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> frontier;
+    frontier.emplace(heap[0].dueAt, 0);
+    while (!frontier.empty() && due.size() < k) {
+        size_t index = frontier.top().second;
+        frontier.pop();
+        due.push_back(heap[index]);
+
+        for (size_t child = 2 * index + 1; child <= 2 * index + 2 && child < heap.size(); ++child) {
+            if (heap[child].dueAt <= time) {
+                frontier.emplace(heap[child].dueAt, child);
+            }
+        }
+    }
+    return due;
+}
+
+size_t DueQueue::countDueBefore(int64_t time) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    // Subtrees whose root is not due hold nothing due either
+    size_t count = 0;
+    std::vector<size_t> pending;
+    if (!heap.empty()) pending.push_back(0);
+    while (!pending.empty()) {
+        size_t index = pending.back();
+        pending.pop_back();
+        if (heap[index].dueAt > time) continue;
+
+        count++;
+        for (size_t child = 2 * index + 1; child <= 2 * index + 2 && child < heap.size(); ++child) {
+            pending.push_back(child);
+        }
+    }
+    return count;
+}
+
+void DueQueue::siftUp(size_t index) {
+    while (index > 0) {
+        size_t parent = (index - 1) / 2;
+        if (heap[parent].dueAt <= heap[index].dueAt) break;
+        swapEntries(parent, index);
+        index = parent;
+    }
+}
+
+void DueQueue::siftDown(size_t index) {
+    const size_t count = heap.size();
+    while (true) {
+        size_t smallest = index;
+        size_t left = 2 * index + 1;
+        size_t right = left + 1;
+        if (left < count && heap[left].dueAt < heap[smallest].dueAt) smallest = left;
+        if (right < count && heap[right].dueAt < heap[smallest].dueAt) smallest = right;
+        if (smallest == index) break;
+        swapEntries(index, smallest);
+        index = smallest;
+    }
+}
+
+void DueQueue::swapEntries(size_t a, size_t b) {
+    std::swap(heap[a], heap[b]);
+    positions[heap[a].word] = a;
+    positions[heap[b].word] = b;
+}
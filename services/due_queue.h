@@ -0,0 +1,52 @@
+#ifndef DUE_QUEUE_H
+#define DUE_QUEUE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// In-memory due dates of the logged-in user's cards: an indexed binary
+// min-heap on next review time. Loaded once at login and kept current as
+// answers are recorded, so session starts and due counts need no query.
+//
+// Thread-safe; sessions are prepared on reader threads while the GUI
+// thread records answers.
+class DueQueue {
+public:
+    struct Entry {
+        std::string word;
+        int64_t dueAt;   // Epoch seconds
+    };
+
+    // Replaces the contents with one user's cards. O(n).
+    void load(const std::string& username, std::vector<Entry> entries);
+    void clear();
+    std::string getUsername() const;
+    size_t size() const;
+
+    // Inserts the card or moves it to its new due time. O(log n).
+    void update(const std::string& word, int64_t dueAt);
+    bool remove(const std::string& word);
+
+    // Up to k cards due at or before `time`, soonest first. O(k log k).
+    std::vector<Entry> nextDue(size_t k,
+                               int64_t time = std::numeric_limits<int64_t>::max()) const;
+    // Cards due at or before `time`. Visits only those cards.
+    size_t countDueBefore(int64_t time) const;
+
+private:
+    void siftUp(size_t index);
+    void siftDown(size_t index);
+    void swapEntries(size_t a, size_t b);
+
+    mutable std::mutex mutex;
+    std::string username;
+    std::vector<Entry> heap;
+    std::unordered_map<std::string, size_t> positions;   // word -> heap index
+};
+
+#endif // DUE_QUEUE_H
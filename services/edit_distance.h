@@ -0,0 +1,144 @@
+#ifndef EDIT_DISTANCE_H
+#define EDIT_DISTANCE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Levenshtein distance over bytes (char) or code points (char32_t), shared
+// by DistractorIndex and AnswerGrader.
+
+namespace edit_distance_detail {
+    // Match masks of a pattern by character
+    template <typename Char>
+    class MaskTable;
+
+    // Bytes index the masks directly
+    template <>
+    class MaskTable<char> {
+    public:
+        void add(char c, uint64_t bit) { masks[static_cast<unsigned char>(c)] |= bit; }
+        uint64_t get(char c) const { return masks[static_cast<unsigned char>(c)]; }
+
+    private:
+        uint64_t masks[256] = {};
+    };
+
+    // Code points are too many to index directly, so they go in a small
+    // open-addressed table
+    template <>
+    class MaskTable<char32_t> {
+    public:
+        MaskTable() { std::fill(std::begin(keys), std::end(keys), kEmpty); }
+
+        void add(char32_t c, uint64_t bit) {
+            size_t slot = hash(c);
+            while (keys[slot] != kEmpty && keys[slot] != c) {
+                slot = (slot + 1) % kSlots;
+            }
+            keys[slot] = c;
+            masks[slot] |= bit;
+        }
+
+        uint64_t get(char32_t c) const {
+            for (size_t slot = hash(c);; slot = (slot + 1) % kSlots) {
+                if (keys[slot] == c) return masks[slot];
+                if (keys[slot] == kEmpty) return 0;
+            }
+        }
+
+    private:
+        // Twice the longest pattern, so probe runs stay short
+        static constexpr size_t kSlots = 128;
+        static constexpr char32_t kEmpty = 0xFFFFFFFF;
+
+        static size_t hash(char32_t c) {
+            return (static_cast<uint32_t>(c) * 0x9E3779B1u) >> 25;
+        }
+
+        char32_t keys[kSlots];
+        uint64_t masks[kSlots] = {};
+    };
+}
+
+// Myers' bit-parallel algorithm against a fixed pattern of at most
+// kMaxLength characters: one pass of word operations per character of the
+// text. Build it once to compare one string against many.
+template <typename Char>
+class MyersPattern {
+public:
+    static constexpr size_t kMaxLength = 64;
+
+    explicit MyersPattern(const std::basic_string<Char>& pattern) : length(pattern.size()) {
+        if (length > kMaxLength) {
+            throw std::length_error("Pattern is longer than 64 characters");
+        }
+        for (size_t i = 0; i < length; ++i) {
+            masks.add(pattern[i], uint64_t{1} << i);
+        }
+    }
+
+    size_t distance(const Char* text, size_t count) const {
+        if (length == 0) return count;
+
+        const uint64_t last = uint64_t{1} << (length - 1);
+        uint64_t pv = ~uint64_t{0};
+        uint64_t mv = 0;
+        size_t distance = length;
+        for (const Char* end = text + count; text != end; ++text) {
+            uint64_t eq = masks.get(*text);
+            uint64_t xv = eq | mv;
+            uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+            uint64_t ph = mv | ~(xh | pv);
+            uint64_t mh = pv & xh;
+            if (ph & last) {
+                distance++;
+            } else if (mh & last) {
+                distance--;
+            }
+            ph = (ph << 1) | 1;
+            mh <<= 1;
+            pv = mh | ~(xv | ph);
+            mv = ph & xv;
+        }
+        return distance;
+    }
+
+    size_t distance(const std::basic_string<Char>& text) const {
+        return distance(text.data(), text.size());
+    }
+
+private:
+    size_t length;
+    edit_distance_detail::MaskTable<Char> masks;
+};
+
+// Uses MyersPattern when either side fits in one, otherwise the row-by-row
+// dynamic program
+template <typename Char>
+size_t editDistance(const std::basic_string<Char>& a, const std::basic_string<Char>& b) {
+    using Pattern = MyersPattern<Char>;
+    if (a.size() <= Pattern::kMaxLength) return Pattern(a).distance(b);
+    if (b.size() <= Pattern::kMaxLength) return Pattern(b).distance(a);
+
+    std::vector<size_t> row(b.size() + 1);
+    std::iota(row.begin(), row.end(), 0);
+    for (size_t i = 1; i <= a.size(); ++i) {
+        size_t diagonal = row[0];
+        row[0] = i;
+        for (size_t j = 1; j <= b.size(); ++j) {
+            size_t above = row[j];
+            size_t substitute = diagonal + (a[i - 1] == b[j - 1] ? 0 : 1);
+            row[j] = std::min(std::min(row[j], row[j - 1]) + 1, substitute);
+            diagonal = above;
+        }
+    }
+    return row[b.size()];
+}
+
+#endif // EDIT_DISTANCE_H
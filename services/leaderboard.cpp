@@ -0,0 +1,231 @@
+#include "leaderboard.h"
+#include <algorithm>
+#include <utility>
+
+void Leaderboard::load(std::vector<Entry> entries) {
+    std::lock_guard<std::mutex> lock(mutex);
+    nodes.clear();
+    freeIds.clear();
+    byUsername.clear();
+    root = kNone;
+
+    // Keep the last score of a repeated user
+    std::unordered_map<std::string, size_t> latest;
+    latest.reserve(entries.size());
+    for (size_t i = 0; i < entries.size(); ++i) {
+        latest[entries[i].username] = i;
+    }
+    std::vector<Entry> ordered;
+    ordered.reserve(latest.size());
+    for (const auto& [username, index] : latest) {
+        ordered.push_back(std::move(entries[index]));
+    }
+    std::sort(ordered.begin(), ordered.end(), before);
+
+    // Entries are already in order, so the treap is the Cartesian tree of
+    // their priorities: one pass with a stack of the rightmost path
+    nodes.reserve(ordered.size());
+    std::vector<Id> rightPath;
+    for (auto& entry : ordered) {
+        Id id = static_cast<Id>(nodes.size());
+        byUsername.emplace(entry.username, id);
+        nodes.push_back({std::move(entry), static_cast<uint32_t>(random())});
+
+        Id lastPopped = kNone;
+        while (!rightPath.empty() && nodes[rightPath.back()].priority < nodes[id].priority) {
+            lastPopped = rightPath.back();
+            rightPath.pop_back();
+        }
+        nodes[id].left = lastPopped;
+        if (!rightPath.empty()) {
+            nodes[rightPath.back()].right = id;
+        }
+        rightPath.push_back(id);
+    }
+    if (!rightPath.empty()) {
+        root = rightPath.front();
+    }
+
+    auto fixSizes = [this](auto& self, Id id) -> size_t {
+        if (id == kNone) return 0;
+        nodes[id].size = 1 + self(self, nodes[id].left) + self(self, nodes[id].right);
+        return nodes[id].size;
+    };
+    fixSizes(fixSizes, root);
+}
+
+void Leaderboard::update(const std::string& username, int score) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = byUsername.find(username);
+    if (it != byUsername.end()) {
+        Id id = it->second;
+        if (nodes[id].entry.score == score) return;
+
+        root = erase(root, id);
+        nodes[id].entry.score = score;
+        insertNode(id);
+        return;
+    }
+
+    Id id;
+    Node node{{username, score}, static_cast<uint32_t>(random())};
+    if (!freeIds.empty()) {
+        id = freeIds.back();
+        freeIds.pop_back();
+        nodes[id] = std::move(node);
+    } else {
+        id = static_cast<Id>(nodes.size());
+        nodes.push_back(std::move(node));
+    }
+    byUsername.emplace(username, id);
+    insertNode(id);
+}
+
+bool Leaderboard::remove(const std::string& username) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = byUsername.find(username);
+    if (it == byUsername.end()) return false;
+
+    Id id = it->second;
+    root = erase(root, id);
+    byUsername.erase(it);
+    nodes[id].entry.username.clear();
+    freeIds.push_back(id);
+    return true;
+}
+
+size_t Leaderboard::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return byUsername.size();
+}
+
+std::vector<Leaderboard::Entry> Leaderboard::top(size_t n) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<Entry> entries;
+    size_t skip = 0;
+    size_t count = std::min(n, sizeOf(root));
+    entries.reserve(count);
+    collect(root, skip, count, entries);
+    return entries;
+}
+
+std::optional<size_t> Leaderboard::rankOf(const std::string& username) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = byUsername.find(username);
+    if (it == byUsername.end()) return std::nullopt;
+    return countBefore(nodes[it->second].entry) + 1;
+}
+
+std::vector<Leaderboard::Entry> Leaderboard::around(const std::string& username, size_t radius,
+                                                    size_t* firstRank) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<Entry> entries;
+    auto it = byUsername.find(username);
+    if (it == byUsername.end()) return entries;
+
+    size_t index = countBefore(nodes[it->second].entry);
+    size_t skip = index > radius ? index - radius : 0;
+    size_t count = std::min(index + radius + 1, sizeOf(root)) - skip;
+    if (firstRank) {
+        *firstRank = skip + 1;
+    }
+    entries.reserve(count);
+    collect(root, skip, count, entries);
+    return entries;
+}
+
+bool Leaderboard::before(const Entry& a, const Entry& b) {
+    if (a.score != b.score) return a.score > b.score;
+    return a.username < b.username;
+}
+
+void Leaderboard::pull(Id id) {
+    nodes[id].size = 1 + sizeOf(nodes[id].left) + sizeOf(nodes[id].right);
+}
+
+void Leaderboard::split(Id t, const Entry& key, Id& less, Id& rest) {
+    if (t == kNone) {
+        less = rest = kNone;
+        return;
+    }
+    if (before(nodes[t].entry, key)) {
+        split(nodes[t].right, key, nodes[t].right, rest);
+        less = t;
+    } else {
+        split(nodes[t].left, key, less, nodes[t].left);
+        rest = t;
+    }
+    pull(t);
+}
+
+Leaderboard::Id Leaderboard::merge(Id a, Id b) {
+    // Every key in a is ranked before every key in b
+    if (a == kNone) return b;
+    if (b == kNone) return a;
+    if (nodes[a].priority > nodes[b].priority) {
+        nodes[a].right = merge(nodes[a].right, b);
+        pull(a);
+        return a;
+    }
+    nodes[b].left = merge(a, nodes[b].left);
+    pull(b);
+    return b;
+}
+
+void Leaderboard::insertNode(Id id) {
+    Node& node = nodes[id];
+    node.left = node.right = kNone;
+    node.size = 1;
+
+    Id less;
+    Id rest;
+    split(root, node.entry, less, rest);
+    root = merge(merge(less, id), rest);
+}
+
+Leaderboard::Id Leaderboard::erase(Id t, Id target) {
+    if (t == target) {
+        return merge(nodes[t].left, nodes[t].right);
+    }
+    if (before(nodes[target].entry, nodes[t].entry)) {
+        nodes[t].left = erase(nodes[t].left, target);
+    } else {
+        nodes[t].right = erase(nodes[t].right, target);
+    }
+    pull(t);
+    return t;
+}
+
+size_t Leaderboard::countBefore(const Entry& key) const {
+    size_t count = 0;
+    for (Id t = root; t != kNone;) {
+        if (before(nodes[t].entry, key)) {
+            count += sizeOf(nodes[t].left) + 1;
+            t = nodes[t].right;
+        } else {
+            t = nodes[t].left;
+        }
+    }
+    return count;
+}
+
+void Leaderboard::collect(Id t, size_t& skip, size_t& count, std::vector<Entry>& out) const {
+    // In-order walk that steps over whole subtrees while skipping
+    if (t == kNone || count == 0) return;
+
+    size_t leftSize = sizeOf(nodes[t].left);
+    if (skip < leftSize) {
+        collect(nodes[t].left, skip, count, out);
+    } else {
+        skip -= leftSize;
+    }
+    if (count == 0) return;
+
+    if (skip > 0) {
+        skip--;
+    } else {
+        out.push_back(nodes[t].entry);
+        count--;
+    }
+    collect(nodes[t].right, skip, count, out);
+}
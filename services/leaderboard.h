@@ -0,0 +1,75 @@
+#ifndef LEADERBOARD_H
+#define LEADERBOARD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Every user's total score, ordered highest first (ties by username, as in
+// idx_users_score). An order-statistic treap: each node knows the size of
+// its subtree, so ranks and rank ranges take O(log n) on top of the
+// entries returned. Loaded once at startup and kept current on every
+// score change.
+//
+// Thread-safe.
+class Leaderboard {
+public:
+    struct Entry {
+        std::string username;
+        int score;
+    };
+
+    // Replaces the contents. O(n log n) for the sort, O(n) to build.
+    void load(std::vector<Entry> entries);
+    // Inserts the user or moves them to their new score. O(log n).
+    void update(const std::string& username, int score);
+    bool remove(const std::string& username);
+    size_t size() const;
+
+    // The n best users, best first
+    std::vector<Entry> top(size_t n) const;
+    // 1-based place of the user, if ranked
+    std::optional<size_t> rankOf(const std::string& username) const;
+    // Users up to `radius` places above and below the user, best first.
+    // `firstRank` receives the rank of the first of them.
+    std::vector<Entry> around(const std::string& username, size_t radius,
+                              size_t* firstRank = nullptr) const;
+
+private:
+    using Id = uint32_t;
+    static constexpr Id kNone = UINT32_MAX;
+
+    struct Node {
+        Entry entry;
+        uint32_t priority;      // Max-heap order
+        Id left = kNone;
+        Id right = kNone;
+        size_t size = 1;        // Nodes in this subtree
+    };
+
+    static bool before(const Entry& a, const Entry& b);
+    size_t sizeOf(Id id) const { return id == kNone ? 0 : nodes[id].size; }
+    void pull(Id id);
+    // Splits t into the nodes ranked before `key` and the rest
+    void split(Id t, const Entry& key, Id& less, Id& rest);
+    Id merge(Id a, Id b);
+    void insertNode(Id id);
+    Id erase(Id t, Id target);
+    // Nodes ranked before `key`
+    size_t countBefore(const Entry& key) const;
+    void collect(Id t, size_t& skip, size_t& count, std::vector<Entry>& out) const;
+
+    mutable std::mutex mutex;
+    std::vector<Node> nodes;
+    std::vector<Id> freeIds;
+    std::unordered_map<std::string, Id> byUsername;
+    Id root = kNone;
+    std::mt19937 random{std::random_device{}()};
+};
+
+#endif // LEADERBOARD_H
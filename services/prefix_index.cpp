@@ -0,0 +1,176 @@
+#include "prefix_index.h"
+#include <algorithm>
+#include <cctype>
+#include <utility>
+
+PrefixIndex::PrefixIndex() : root(std::make_unique<Node>()) {}
+
+PrefixIndex::~PrefixIndex() = default;
+
+std::string PrefixIndex::fold(const std::string& text) {
+    std::string folded(text);
+    for (auto& c : folded) {
+        auto byte = static_cast<unsigned char>(c);
+        if (byte < 0x80) {
+            c = static_cast<char>(std::tolower(byte));
+        }
+    }
+    return folded;
+}
+
+void PrefixIndex::build(const std::vector<std::string>& headwords) {
+    clear();
+    for (const auto& headword : headwords) {
+        insert(headword);
+    }
+}
+
+void PrefixIndex::clear() {
+    root = std::make_unique<Node>();
+    count = 0;
+}
+
+void PrefixIndex::insert(const std::string& headword) {
+    const std::string key = fold(headword);
+    Node* node = root.get();
+    size_t pos = 0;
+
+    while (pos < key.size()) {
+        auto it = node->children.find(key[pos]);
+        if (it == node->children.end()) {
+            auto leaf = std::make_unique<Node>();
+            leaf->label = key.substr(pos);
+            node = node->children.emplace(key[pos], std::move(leaf)).first->second.get();
+            pos = key.size();
+            break;
+        }
+
+        Node* child = it->second.get();
+        size_t common = 0;
+        while (common < child->label.size() && pos + common < key.size()
+               && child->label[common] == key[pos + common]) {
+            common++;
+        }
+
+        if (common < child->label.size()) {
+            // Split the edge: the shared part becomes a new inner node
+            auto middle = std::make_unique<Node>();
+            middle->label = child->label.substr(0, common);
+            child->label.erase(0, common);
+            middle->children.emplace(child->label[0], std::move(it->second));
+            it->second = std::move(middle);
+            child = it->second.get();
+        }
+
+        node = child;
+        pos += common;
+    }
+
+    auto& entries = node->headwords;
+    auto slot = std::lower_bound(entries.begin(), entries.end(), headword);
+    if (slot == entries.end() || *slot != headword) {
+        entries.insert(slot, headword);
+        count++;
+    }
+}
+
+bool PrefixIndex::remove(const std::string& headword) {
+    const std::string key = fold(headword);
+
+    // Path of (parent, child) links from the root down to the key's node
+    std::vector<std::pair<Node*, unsigned char>> path;
+    Node* node = root.get();
+    size_t pos = 0;
+    while (pos < key.size()) {
+        auto it = node->children.find(key[pos]);
+        if (it == node->children.end()) return false;
+
+        const std::string& label = it->second->label;
+        if (key.compare(pos, label.size(), label) != 0) return false;
+
+        path.emplace_back(node, key[pos]);
+        node = it->second.get();
+        pos += label.size();
+    }
+
+    auto& entries = node->headwords;
+    auto slot = std::lower_bound(entries.begin(), entries.end(), headword);
+    if (slot == entries.end() || *slot != headword) return false;
+    entries.erase(slot);
+    count--;
+
+    // Drop emptied leaves and merge pass-through nodes back into one edge,
+    // so the tree stays compressed
+    while (!path.empty()) {
+        auto [parent, edge] = path.back();
+        path.pop_back();
+        auto& link = parent->children[edge];
+        Node* current = link.get();
+
+        if (!current->headwords.empty()) break;
+
+        if (current->children.empty()) {
+            parent->children.erase(edge);
+            continue;   // The parent may now be a pass-through node
+        }
+        if (current->children.size() == 1) {
+            auto only = std::move(current->children.begin()->second);
+            only->label = current->label + only->label;
+            link = std::move(only);
+        }
+        break;
+    }
+    return true;
+}
+
+bool PrefixIndex::contains(const std::string& headword) const {
+    const std::string key = fold(headword);
+    const Node* node = root.get();
+    size_t pos = 0;
+    while (pos < key.size()) {
+        auto it = node->children.find(key[pos]);
+        if (it == node->children.end()) return false;
+
+        const std::string& label = it->second->label;
+        if (key.compare(pos, label.size(), label) != 0) return false;
+
+        node = it->second.get();
+        pos += label.size();
+    }
+    return std::binary_search(node->headwords.begin(), node->headwords.end(), headword);
+}
+
+std::vector<std::string> PrefixIndex::withPrefix(const std::string& prefix, size_t limit) const {
+    std::vector<std::string> out;
+    if (limit == 0) return out;
+
+    const std::string key = fold(prefix);
+    const Node* node = root.get();
+    size_t pos = 0;
+    while (pos < key.size()) {
+        auto it = node->children.find(key[pos]);
+        if (it == node->children.end()) return out;
+
+        // The prefix may end part-way along an edge
+        const std::string& label = it->second->label;
+        size_t length = std::min(label.size(), key.size() - pos);
+        if (key.compare(pos, length, label, 0, length) != 0) return out;
+
+        node = it->second.get();
+        pos += length;
+    }
+
+    collect(*node, limit, out);
+    return out;
+}
+
+void PrefixIndex::collect(const Node& node, size_t limit, std::vector<std::string>& out) {
+    for (const auto& headword : node.headwords) {
+        if (out.size() >= limit) return;
+        out.push_back(headword);
+    }
+    for (const auto& [edge, child] : node.children) {
+        if (out.size() >= limit) return;
+        collect(*child, limit, out);
+    }
+}
@@ -0,0 +1,55 @@
+#ifndef PREFIX_INDEX_H
+#define PREFIX_INDEX_H
+
+#include <cstddef>
+#include <limits>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Compressed prefix trie (radix tree) over English headwords, for
+// search-as-you-type without a database round trip. Keys are matched
+// case-insensitively (ASCII folding, byte-wise, so UTF-8 passes through
+// unchanged); lookups return the headwords as they were inserted.
+//
+// Not thread-safe: owned by WordService and used from the GUI thread.
+class PrefixIndex {
+public:
+    PrefixIndex();
+    ~PrefixIndex();
+
+    PrefixIndex(const PrefixIndex&) = delete;
+    PrefixIndex& operator=(const PrefixIndex&) = delete;
+
+    void build(const std::vector<std::string>& headwords);
+    void insert(const std::string& headword);
+    bool remove(const std::string& headword);
+    void clear();
+
+    bool contains(const std::string& headword) const;
+    size_t size() const { return count; }
+
+    // Headwords starting with prefix in lexicographic order of their folded
+    // form, at most limit of them. An empty prefix matches everything.
+    std::vector<std::string> withPrefix(
+        const std::string& prefix,
+        size_t limit = std::numeric_limits<size_t>::max()) const;
+
+private:
+    struct Node {
+        std::string label;                  // Edge label leading to this node
+        std::vector<std::string> headwords; // Entries whose folded key ends here
+        // Unsigned, so children iterate in the same byte order std::string
+        // compares in (UTF-8 lead bytes after ASCII)
+        std::map<unsigned char, std::unique_ptr<Node>> children;
+    };
+
+    static std::string fold(const std::string& text);
+    static void collect(const Node& node, size_t limit, std::vector<std::string>& out);
+
+    std::unique_ptr<Node> root;
+    size_t count = 0;
+};
+
+#endif // PREFIX_INDEX_H
@@ -1,19 +1,223 @@
 #include "review_service.h"
+#include <QDateTime>
+#include <QDebug>
+#include <QString>
+#include <algorithm>
 #include <stdexcept>
 
+namespace {
+
+std::shared_ptr<const SchedulerEngine> schedulerFromEnvironment() {
+    QString name = qEnvironmentVariable("WORD_SYSTEM_SCHEDULER", "sm2").trimmed().toLower();
+    std::shared_ptr<const SchedulerEngine> engine = SchedulerEngine::create(name.toStdString());
+    if (!engine) {
+        qWarning() << "Unknown scheduler" << name << "- expected sm2 or fsrs; using sm2";
+        engine = std::make_shared<Sm2Scheduler>();
+    }
+    return engine;
+}
+
+} // namespace
+
+ReviewService::ReviewService(WriteBehindQueue* writeQueue, WordCache* wordCache,
+                             DueQueue* dueQueue)
+    : wordRepository(std::make_unique<WordRepository>()),
+      userRepository(std::make_unique<UserRepository>()),
+      writeQueue(writeQueue), wordCache(wordCache), dueQueue(dueQueue),
+      scheduler(schedulerFromEnvironment()) {}
+
+void ReviewService::loadDueQueue(const std::string& username) {
+    if (!dueQueue) return;
+    
+    std::vector<DueQueue::Entry> entries;
+    for (auto& [word, dueAt] : wordRepository->getReviewSchedule(username)) {
+        entries.push_back({std::move(word), dueAt});
+    }
+    dueQueue->load(username, std::move(entries));
+}
+
+int ReviewService::countDueToday(const std::string& username) const {
+    qint64 endOfToday =
+        QDateTime(QDate::currentDate().addDays(1), QTime(0, 0)).toSecsSinceEpoch() - 1;
+    if (dueQueue && dueQueue->getUsername() == username) {
+        return static_cast<int>(dueQueue->countDueBefore(endOfToday));
+    }
+    return wordRepository->countDueBefore(username, endOfToday);
+}
+
+int ReviewService::rescheduleAll(const std::string& username) {
+    // Stored state must include every answer given so far
+    if (writeQueue) {
+        writeQueue->flush();
+    }
+    
+    int changed = 0;
+    if (!wordRepository->rescheduleCards(username, *scheduler, changed)) {
+        throw std::runtime_error("Failed to reschedule cards");
+    }
+    
+    // The due queue and a prefetched session follow the old due dates
+    if (dueQueue && dueQueue->getUsername() == username) {
+        loadDueQueue(username);
+    }
+    invalidatePrefetch();
+    return changed;
+}
+
+int ReviewService::applyScheduler(const std::string& username) {
+    const std::string previous = userRepository->getScheduler(username);
+    if (previous.empty() || previous == scheduler->name()) return 0;
+    
+    int changed = rescheduleAll(username);
+    if (!userRepository->setScheduler(username, scheduler->name())) {
+        // Rescheduling again at the next login gives the same due dates
+        qWarning() << "Could not record the scheduler of" << QString::fromStdString(username);
+    }
+    return changed;
+}
+
 void ReviewService::startNewSession(const std::string& username, int wordCount) {
+    if (prefetchPending && prefetchUser == username && prefetchCount == wordCount
+        && prefetched.isFinished()) {
+        prefetchPending = false;
+        startSession(prefetched.result());
+        return;
+    }
+    startSession(prepareSession(username, wordCount));
+}
+
+ReviewService::PreparedSession ReviewService::prepareSession(const std::string& username,
+                                                             int wordCount) {
+    return prepareSession(username, wordCount, {});
+}
+
+ReviewService::PreparedSession ReviewService::prepareSession(
+    const std::string& username, int wordCount, std::set<std::string> exclude) {
     if (wordCount <= 0) {
         throw std::invalid_argument("Word count must be positive");
     }
     
-    currentUser = username;
-    auto dueWords = wordRepository->findDueForReview(username, wordCount);
+    // Cards whose answers are still on their way to the database would be
+    // read with their old state, so they wait for a later session
+    if (writeQueue) {
+        std::set<std::string> unwritten = writeQueue->unwrittenWords(username);
+        exclude.insert(unwritten.begin(), unwritten.end());
+    }
+    
+    PreparedSession prepared;
+    prepared.username = username;
+    prepared.wordCount = wordCount;
+    if (dueQueue && dueQueue->getUsername() == username) {
+        // The most overdue cards, straight from memory
+        std::vector<std::string> dueWords;
+        for (auto& entry : dueQueue->nextDue(wordCount + exclude.size(),
+                                             QDateTime::currentSecsSinceEpoch())) {
+            if (static_cast<int>(dueWords.size()) < wordCount && !exclude.count(entry.word)) {
+                dueWords.push_back(std::move(entry.word));
+            }
+        }
+        prepared.words = wordRepository->findReviewWords(username, dueWords, wordCount, exclude);
+        
+        // Words deleted since login are not returned; stop offering them
+        std::set<std::string> found;
+        for (const auto& word : prepared.words) {
+            found.insert(word.getEnglish());
+        }
+        for (const auto& word : dueWords) {
+            if (!found.count(word)) {
+                dueQueue->remove(word);
+            }
+        }
+    } else {
+        prepared.words = wordRepository->findDueForReview(username, wordCount, exclude);
+    }
     
-    if (dueWords.empty()) {
+    std::vector<std::string> keys;
+    keys.reserve(prepared.words.size());
+    for (const auto& word : prepared.words) {
+        keys.push_back(word.getEnglish());
+    }
+    prepared.cards = wordRepository->getCardStates(username, keys);
+    return prepared;
+}
+
+QFuture<ReviewService::PreparedSession> ReviewService::prepareSessionAsync(
+    const std::string& username, int wordCount) {
+    return runOnReaders([this, username, wordCount] {
+        return prepareSession(username, wordCount);
+    });
+}
+
+void ReviewService::startSession(PreparedSession prepared) {
+    if (prepared.words.empty()) {
         throw std::runtime_error("No words due for review");
     }
     
-    currentSession = std::make_unique<ReviewSession>(dueWords);
+    currentUser = prepared.username;
+    currentSession = std::make_unique<ReviewSession>(prepared.words, scheduler,
+                                                     prepared.cards);
+    
+    prefetchNextSession(prepared.username,
+                        prepared.wordCount > 0 ? prepared.wordCount
+                                               : static_cast<int>(prepared.words.size()));
+}
+
+void ReviewService::prefetchNextSession(const std::string& username, int wordCount) {
+    if (username.empty() || wordCount <= 0) return;
+    
+    // Cards of the running session are still due until its results are
+    // written, so leave them out
+    std::set<std::string> exclude;
+    if (currentSession && currentUser == username) {
+        for (const auto& item : currentSession->getItems()) {
+            exclude.insert(item.word.getEnglish());
+        }
+    }
+    
+    prefetchUser = username;
+    prefetchCount = wordCount;
+    prefetchPending = true;
+    uint64_t generation = ++prefetchGeneration;
+    prefetched = runOnReaders([this, username, wordCount, exclude, generation] {
+        if (prefetchGeneration.load() != generation) {
+            return PreparedSession();
+        }
+        return prepareSession(username, wordCount, exclude);
+    });
+}
+
+QFuture<ReviewService::PreparedSession> ReviewService::nextSessionAsync(
+    const std::string& username, int wordCount) {
+    if (prefetchPending && prefetchUser == username && prefetchCount == wordCount) {
+        prefetchPending = false;
+        return prefetched;
+    }
+    return prepareSessionAsync(username, wordCount);
+}
+
+void ReviewService::invalidatePrefetch() {
+    if (!prefetchPending) return;
+    
+    prefetchPending = false;
+    prefetched = QFuture<PreparedSession>();
+    prefetchNextSession(prefetchUser, prefetchCount);
+}
+
+void ReviewService::invalidatePrefetchFor(const std::string& english) {
+    if (!prefetchPending) return;
+    
+    // A load still running may have read the word before or after the change
+    if (prefetched.isFinished()) {
+        try {
+            const PreparedSession prepared = prefetched.result();
+            bool holdsWord = std::any_of(prepared.words.begin(), prepared.words.end(),
+                [&english](const Word& word) { return word.getEnglish() == english; });
+            if (!holdsWord) return;
+        } catch (const QException&) {
+            // A failed load is retried below
+        }
+    }
+    invalidatePrefetch();
 }
 
 void ReviewService::endSession() {
@@ -21,13 +225,28 @@ void ReviewService::endSession() {
         throw std::runtime_error("No active review session");
     }
     
-    // Save review results to database
+    // Save review results to database in one transaction, or hand them to
+    // the background writer
+    std::vector<WordRepository::ReviewResult> results;
     for (const auto& item : currentSession->getItems()) {
         if (item.reviewed) {
-            updateWordDifficulty(item.word.getEnglish(), item.correct);
+            results.push_back({item.word.getEnglish(), item.correct, currentUser,
+                               item.card, item.answeredAt, item.responseTime});
+        }
+    }
+    
+    if (wordCache) {
+        for (const auto& result : results) {
+            wordCache->recordAttempt(result.english, result.correct);
         }
     }
     
+    if (writeQueue) {
+        writeQueue->enqueueReviewResults(results);
+    } else if (!wordRepository->recordResults(results)) {
+        throw std::runtime_error("Failed to save review results");
+    }
+    
     currentSession.reset();
 }
 
@@ -49,7 +268,13 @@ void ReviewService::recordAttempt(bool correct) {
     if (!currentSession) {
         throw std::runtime_error("No active review session");
     }
+    if (!currentSession->hasNext()) return;
+    
+    const auto& item = currentSession->getCurrentItem();
     currentSession->recordAttempt(correct);
+    if (dueQueue && dueQueue->getUsername() == currentUser) {
+        dueQueue->update(item.word.getEnglish(), item.card.nextReviewAt);
+    }
 }
 
 double ReviewService::getCurrentAccuracy() const {
@@ -88,15 +313,18 @@ std::vector<ReviewSession::ReviewItem> ReviewService::getReviewedItems() const {
 }
 
 void ReviewService::updateWordDifficulty(const std::string& english, bool wasCorrect) {
-    auto word = wordRepository->findByEnglish(english);
-    if (!word) {
+    if (!wordRepository->incrementStats(english, 1, wasCorrect ? 1 : 0, 1)) {
         throw std::runtime_error("Word not found");
     }
-    
-    word->recordAttempt(wasCorrect);
-    wordRepository->update(*word);
+    if (wordCache) {
+        wordCache->recordAttempt(english, wasCorrect);
+    }
 }
 
 std::vector<Word> ReviewService::getMostDifficultWords(int limit) {
     return wordRepository->getMostDifficultWords(limit);
 }
+
+QFuture<std::vector<Word>> ReviewService::getMostDifficultWordsAsync(int limit) {
+    return runOnReaders([this, limit] { return getMostDifficultWords(limit); });
+}
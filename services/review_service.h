@@ -2,20 +2,99 @@
 #define REVIEW_SERVICE_H
 
 #include "../models/review_session.h"
+#include "../repositories/user_repository.h"
 #include "../repositories/word_repository.h"
+#include "async_task.h"
+#include "due_queue.h"
+#include "word_cache.h"
+#include "write_behind_queue.h"
+#include <QFuture>
+#include <atomic>
+#include <cstdint>
+#include <map>
 #include <memory>
+#include <set>
 
 class ReviewService {
+public:
+    // The cards of a session, loaded before the session starts
+    struct PreparedSession {
+        std::string username;
+        int wordCount = 0;
+        std::vector<Word> words;
+        std::map<std::string, CardState> cards;
+    };
+
 private:
     std::unique_ptr<WordRepository> wordRepository;
+    std::unique_ptr<UserRepository> userRepository;
+    WriteBehindQueue* writeQueue;
+    WordCache* wordCache;
+    DueQueue* dueQueue;
+    std::shared_ptr<const SchedulerEngine> scheduler;
     std::unique_ptr<ReviewSession> currentSession;
     std::string currentUser;
+    
+    // The next session, loading in the background. Only touched on the GUI
+    // thread; dropping the future discards a result that is still coming.
+    // Each prefetch takes a new generation, and a task that has been
+    // superseded by the time it runs returns without loading anything.
+    QFuture<PreparedSession> prefetched;
+    bool prefetchPending = false;
+    std::string prefetchUser;
+    int prefetchCount = 0;
+    std::atomic<uint64_t> prefetchGeneration{0};
+    
+    // Leaves out exclude and the cards with answers not yet written
+    PreparedSession prepareSession(const std::string& username, int wordCount,
+                                   std::set<std::string> exclude);
 
 public:
-    ReviewService() : wordRepository(std::make_unique<WordRepository>()) {}
+    // With a write queue, session results are persisted in the background.
+    // Answers are also applied to wordCache and dueQueue, if given, to keep
+    // them current. The scheduler is picked with the WORD_SYSTEM_SCHEDULER environment
+    // variable ("sm2" or "fsrs"), defaulting to SM-2.
+    explicit ReviewService(WriteBehindQueue* writeQueue = nullptr,
+                           WordCache* wordCache = nullptr,
+                           DueQueue* dueQueue = nullptr);
     
-    // Session management
+    // Loads the user's due dates into the due queue, once per login. Sessions
+    // for that user then take their due cards from memory.
+    void loadDueQueue(const std::string& username);
+    // Cards scheduled for review before the end of today
+    int countDueToday(const std::string& username) const;
+    
+    // Scheduling. rescheduleAll moves the due dates of all of a user's
+    // cards to match the engine and returns how many changed. applyScheduler
+    // does so once per engine change: called at login, it reschedules the
+    // cards if another engine set them, and records this one.
+    const SchedulerEngine& getScheduler() const { return *scheduler; }
+    int rescheduleAll(const std::string& username);
+    int applyScheduler(const std::string& username);
+    
+    // Session management. startNewSession is the synchronous API: unless a
+    // matching prefetch has already finished, it loads the cards on the
+    // calling thread. The GUI goes through nextSessionAsync instead.
     void startNewSession(const std::string& username, int wordCount = 10);
+    // prepareSession only reads, so it can run off the GUI thread;
+    // startSession then installs the result
+    PreparedSession prepareSession(const std::string& username, int wordCount = 10);
+    QFuture<PreparedSession> prepareSessionAsync(const std::string& username, int wordCount = 10);
+    void startSession(PreparedSession prepared);
+    
+    // The next session's cards are loaded in the background after login
+    // and while a session runs, leaving out the cards of the running one.
+    // nextSessionAsync hands over that prefetch when it matches, otherwise
+    // it starts loading. startSession begins the following prefetch.
+    void prefetchNextSession(const std::string& username, int wordCount = 10);
+    QFuture<PreparedSession> nextSessionAsync(const std::string& username, int wordCount = 10);
+    // Drops a prefetched session whose cards may be stale (e.g. after
+    // rescheduling) and starts loading it again
+    void invalidatePrefetch();
+    // The same, but only if the prefetched session holds english or is still
+    // loading. Other edits cannot change it: the new words that top up a
+    // session are a random pick, so a word added meanwhile may be left out.
+    void invalidatePrefetchFor(const std::string& english);
     void endSession();
     bool hasActiveSession() const { return currentSession != nullptr; }
     
@@ -34,6 +113,7 @@ public:
     // Word difficulty tracking
     void updateWordDifficulty(const std::string& english, bool wasCorrect);
     std::vector<Word> getMostDifficultWords(int limit = 10);
+    QFuture<std::vector<Word>> getMostDifficultWordsAsync(int limit = 10);
 };
 
 #endif // REVIEW_SERVICE_H
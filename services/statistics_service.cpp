@@ -1,10 +1,12 @@
 #include "statistics_service.h"
+#include <QDateTime>
 #include <algorithm>
 #include <numeric>
 
-StatisticsService::StatisticsService()
+StatisticsService::StatisticsService(const DueQueue* dueQueue)
     : wordRepository(std::make_unique<WordRepository>()),
-      userRepository(std::make_unique<UserRepository>()) {}
+      userRepository(std::make_unique<UserRepository>()),
+      dueQueue(dueQueue) {}
 
 StatisticsService::UserProgress StatisticsService::getUserProgress(const std::string& username) {
     UserProgress progress{};
@@ -44,22 +46,16 @@ StatisticsService::UserProgress StatisticsService::getUserProgress(const std::st
 std::vector<StatisticsService::DailyStats> StatisticsService::getDailyStats(
     const std::string& username, int days) {
     std::vector<DailyStats> stats;
-    auto now = std::chrono::system_clock::now();
     
-    for (int i = 0; i < days; ++i) {
-        auto date = now - std::chrono::hours(24 * i);
-        auto dayStats = wordRepository->getDailyStats(username, date);
-        
-        // Convert repository stats to service stats
-        for (const auto& ds : dayStats) {
-            DailyStats stat;
-            stat.date = ds.date;
-            stat.wordsLearned = ds.wordsLearned;
-            stat.wordsReviewed = ds.wordsReviewed;
-            stat.correctCount = static_cast<int>(ds.wordsReviewed * ds.accuracy);
-            stat.accuracy = ds.accuracy;
-            stats.push_back(stat);
-        }
+    // Convert repository stats to service stats
+    for (const auto& ds : wordRepository->getDailyStats(username, days)) {
+        DailyStats stat;
+        stat.date = ds.date;
+        stat.wordsLearned = ds.wordsLearned;
+        stat.wordsReviewed = ds.wordsReviewed;
+        stat.correctCount = ds.correctCount;
+        stat.accuracy = ds.accuracy;
+        stats.push_back(stat);
     }
     
     return stats;
@@ -129,7 +125,16 @@ int StatisticsService::getLongestStreak(const std::string& username) {
 }
 
 int StatisticsService::getTotalReviewTime(const std::string& username) {
-    return wordRepository->getTotalReviewTime(username);
+    return wordRepository->getTotalReviewTime(username) / 60;
+}
+
+int StatisticsService::countDueToday(const std::string& username) {
+    qint64 endOfToday =
+        QDateTime(QDate::currentDate().addDays(1), QTime(0, 0)).toSecsSinceEpoch() - 1;
+    if (dueQueue && dueQueue->getUsername() == username) {
+        return static_cast<int>(dueQueue->countDueBefore(endOfToday));
+    }
+    return wordRepository->countDueBefore(username, endOfToday);
 }
 
 double StatisticsService::getAverageAccuracy(const std::string& username) {
@@ -141,3 +146,31 @@ double StatisticsService::getAverageAccuracy(const std::string& username) {
     
     return totalAccuracy / stats.size();
 }
+
+QFuture<StatisticsService::UserProgress> StatisticsService::getUserProgressAsync(
+    const std::string& username) {
+    return runOnReaders([this, username] { return getUserProgress(username); });
+}
+
+QFuture<std::vector<StatisticsService::DailyStats>> StatisticsService::getDailyStatsAsync(
+    const std::string& username, int days) {
+    return runOnReaders([this, username, days] { return getDailyStats(username, days); });
+}
+
+QFuture<std::map<std::string, int>> StatisticsService::getWordsByCategoryAsync() {
+    return runOnReaders([this] { return getWordsByCategory(); });
+}
+
+QFuture<std::vector<StatisticsService::WordStats>> StatisticsService::getMostDifficultWordsAsync(
+    int limit) {
+    return runOnReaders([this, limit] { return getMostDifficultWords(limit); });
+}
+
+QFuture<std::vector<StatisticsService::WordStats>> StatisticsService::getMostReviewedWordsAsync(
+    int limit) {
+    return runOnReaders([this, limit] { return getMostReviewedWords(limit); });
+}
+
+QFuture<int> StatisticsService::getTotalReviewTimeAsync(const std::string& username) {
+    return runOnReaders([this, username] { return getTotalReviewTime(username); });
+}
@@ -3,6 +3,9 @@
 
 #include "../repositories/word_repository.h"
 #include "../repositories/user_repository.h"
+#include "async_task.h"
+#include "due_queue.h"
+#include <QFuture>
 #include <memory>
 #include <vector>
 #include <map>
@@ -40,10 +43,12 @@ public:
 private:
     std::unique_ptr<WordRepository> wordRepository;
     std::unique_ptr<UserRepository> userRepository;
+    const DueQueue* dueQueue;
     std::string currentUser;
 
 public:
-    StatisticsService();
+    // Due counts come from dueQueue when it holds the user's cards
+    explicit StatisticsService(const DueQueue* dueQueue = nullptr);
     
     // User progress
     UserProgress getUserProgress(const std::string& username);
@@ -58,7 +63,17 @@ public:
     // Achievement tracking
     int getLongestStreak(const std::string& username);
     int getTotalReviewTime(const std::string& username);  // in minutes
+    int countDueToday(const std::string& username);
     double getAverageAccuracy(const std::string& username);
+    
+    // Async variants for the statistics view. They run on the connection
+    // pool's reader threads; use whenFinished() to get the results back.
+    QFuture<UserProgress> getUserProgressAsync(const std::string& username);
+    QFuture<std::vector<DailyStats>> getDailyStatsAsync(const std::string& username, int days = 7);
+    QFuture<std::map<std::string, int>> getWordsByCategoryAsync();
+    QFuture<std::vector<WordStats>> getMostDifficultWordsAsync(int limit = 10);
+    QFuture<std::vector<WordStats>> getMostReviewedWordsAsync(int limit = 10);
+    QFuture<int> getTotalReviewTimeAsync(const std::string& username);
 };
 
 #endif // STATISTICS_SERVICE_H
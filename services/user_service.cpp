@@ -16,9 +16,16 @@ void UserService::login(const std::string& username, const std::string& password
 }
 
 void UserService::logout() {
+    flushPendingWrites();
     currentUser.reset();
 }
 
+void UserService::flushPendingWrites() {
+    if (writeQueue && !writeQueue->flush()) {
+        throw std::runtime_error("保存学习记录失败");
+    }
+}
+
 void UserService::registerUser(const std::string& username, const std::string& password) {
     // Validate input
     if (username.empty() || password.empty()) {
@@ -50,6 +57,8 @@ void UserService::registerUser(const std::string& username, const std::string& p
             "注册失败：无法保存用户信息。请检查数据库连接或权限。"
         );
     }
+    
+    leaderboard.update(newUser.getUsername(), newUser.getStats().totalScore);
 }
 
 void UserService::updatePassword(const std::string& oldPassword, const std::string& newPassword) {
@@ -65,6 +74,7 @@ void UserService::updatePassword(const std::string& oldPassword, const std::stri
         throw std::invalid_argument("新密码不能为空");
     }
     
+    flushPendingWrites();
     User updatedUser = *currentUser;
     updatedUser.updatePassword(newPassword);
     
@@ -81,6 +91,8 @@ void UserService::checkIn() {
         throw std::runtime_error("未登录，无法签到");
     }
     
+    flushPendingWrites();
+    
     // Perform check-in
     currentUser->checkIn();
     
@@ -88,6 +100,7 @@ void UserService::checkIn() {
     if (!repository->update(*currentUser)) {
         throw std::runtime_error("签到失败：无法更新用户信息");
     }
+    leaderboard.update(currentUser->getUsername(), currentUser->getStats().totalScore);
     
     // Prepare detailed check-in message
     std::stringstream message;
@@ -107,11 +120,16 @@ void UserService::addScore(int points) {
     User updatedUser = *currentUser;
     updatedUser.addScore(points);
     
-    if (!repository->update(updatedUser)) {
+    if (writeQueue) {
+        // The in-memory user is current; the database catches up shortly
+        writeQueue->enqueueScore(updatedUser.getUsername(),
+            updatedUser.getStats().totalScore - currentUser->getStats().totalScore);
+    } else if (!repository->update(updatedUser)) {
         throw std::runtime_error("更新积分失败");
     }
     
     currentUser = updatedUser;
+    leaderboard.update(currentUser->getUsername(), currentUser->getStats().totalScore);
 }
 
 void UserService::recordWordLearned() {
@@ -119,6 +137,7 @@ void UserService::recordWordLearned() {
         throw AuthenticationError("用户未登录");
     }
     
+    flushPendingWrites();
     User updatedUser = *currentUser;
     updatedUser.recordWordLearned();
     
@@ -133,6 +152,27 @@ std::vector<User> UserService::getLeaderboard(int limit) {
     return repository->getTopUsers(limit);
 }
 
+void UserService::loadLeaderboard() {
+    std::vector<Leaderboard::Entry> entries;
+    for (auto& [username, score] : repository->getAllScores()) {
+        entries.push_back({std::move(username), score});
+    }
+    leaderboard.load(std::move(entries));
+}
+
+std::vector<Leaderboard::Entry> UserService::getTopScores(size_t count) const {
+    return leaderboard.top(count);
+}
+
+std::optional<size_t> UserService::getCurrentRank() const {
+    return leaderboard.rankOf(getCurrentUser().getUsername());
+}
+
+std::vector<Leaderboard::Entry> UserService::getNearbyUsers(size_t radius,
+                                                           size_t* firstRank) const {
+    return leaderboard.around(getCurrentUser().getUsername(), radius, firstRank);
+}
+
 double UserService::getAverageWordsLearned() {
     return repository->getAverageWordsPerUser();
 }
@@ -2,9 +2,12 @@
 #define USER_SERVICE_H
 
 #include "../repositories/user_repository.h"
+#include "leaderboard.h"
+#include "write_behind_queue.h"
 #include <memory>
 #include <optional>
 #include <stdexcept>
+#include <vector>
 
 class AuthenticationError : public std::runtime_error {
 public:
@@ -15,10 +18,18 @@ public:
 class UserService {
 private:
     std::unique_ptr<UserRepository> repository;
+    WriteBehindQueue* writeQueue;
     std::optional<User> currentUser;
+    Leaderboard leaderboard;
+
+    // Full-row updates must not race queued score deltas
+    void flushPendingWrites();
 
 public:
-    UserService() : repository(std::make_unique<UserRepository>()) {}
+    // With a write queue, score changes are persisted in the background;
+    // without one, every change is written before returning.
+    explicit UserService(WriteBehindQueue* writeQueue = nullptr)
+        : repository(std::make_unique<UserRepository>()), writeQueue(writeQueue) {}
     
     // Authentication
     void login(const std::string& username, const std::string& password);
@@ -47,6 +58,15 @@ public:
     
     // Statistics
     std::vector<User> getLeaderboard(int limit = 10);
+    
+    // Rankings from memory. loadLeaderboard() reads every score once (at
+    // startup); registration and score changes keep it current.
+    void loadLeaderboard();
+    std::vector<Leaderboard::Entry> getTopScores(size_t count = 10) const;
+    std::optional<size_t> getCurrentRank() const;
+    // The current user and up to `radius` users ranked on either side
+    std::vector<Leaderboard::Entry> getNearbyUsers(size_t radius = 2,
+                                                   size_t* firstRank = nullptr) const;
     double getAverageWordsLearned();
     int getCurrentStreak() const;
     int getTotalScore() const;
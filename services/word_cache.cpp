@@ -0,0 +1,131 @@
+#include "word_cache.h"
+#include <algorithm>
+
+WordCache::WordCache(size_t capacity) : maxEntries(std::max<size_t>(capacity, 1)) {}
+
+std::optional<Word> WordCache::get(const std::string& english) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = index.find(english);
+    if (it == index.end()) {
+        misses++;
+        return std::nullopt;
+    }
+
+    hits++;
+    entries.splice(entries.begin(), entries, it->second);
+    return it->second->word;
+}
+
+bool WordCache::contains(const std::string& english) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return index.count(english) > 0;
+}
+
+void WordCache::put(const Word& word) {
+    size_t bytes = estimateSize(word);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    insert(word, bytes);
+}
+
+uint64_t WordCache::generation() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return changes;
+}
+
+void WordCache::putIfCurrent(const Word& word, uint64_t generation) {
+    size_t bytes = estimateSize(word);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (changes != generation) return;
+    insert(word, bytes);
+}
+
+void WordCache::insert(const Word& word, size_t bytes) {
+    auto it = index.find(word.getEnglish());
+    if (it != index.end()) {
+        memoryBytes -= it->second->bytes;
+        it->second->word = word;
+        it->second->bytes = bytes;
+        memoryBytes += bytes;
+        entries.splice(entries.begin(), entries, it->second);
+        return;
+    }
+
+    entries.push_front({word, bytes});
+    index.emplace(word.getEnglish(), entries.begin());
+    memoryBytes += bytes;
+    evictOverflow();
+}
+
+void WordCache::erase(const std::string& english) {
+    std::lock_guard<std::mutex> lock(mutex);
+    changes++;
+    auto it = index.find(english);
+    if (it == index.end()) return;
+
+    memoryBytes -= it->second->bytes;
+    entries.erase(it->second);
+    index.erase(it);
+}
+
+void WordCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    changes++;
+    entries.clear();
+    index.clear();
+    memoryBytes = 0;
+}
+
+void WordCache::recordAttempt(const std::string& english, bool correct) {
+    std::lock_guard<std::mutex> lock(mutex);
+    // A row read before the answer was written would lack it
+    changes++;
+    auto it = index.find(english);
+    if (it != index.end()) {
+        it->second->word.recordAttempt(correct);
+    }
+}
+
+WordCache::Stats WordCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    Stats result;
+    result.hits = hits;
+    result.misses = misses;
+    result.entries = entries.size();
+    result.memoryBytes = memoryBytes;
+    return result;
+}
+
+void WordCache::resetCounters() {
+    std::lock_guard<std::mutex> lock(mutex);
+    hits = 0;
+    misses = 0;
+}
+
+size_t WordCache::estimateSize(const Word& word) {
+    // Object sizes plus string buffers; ignores allocator overhead. The
+    // english key is counted twice because the index holds its own copy.
+    size_t bytes = sizeof(Entry) + sizeof(LruList::value_type*) * 2
+                 + sizeof(std::string) + word.getEnglish().capacity();
+    bytes += word.getEnglish().capacity()
+           + word.getPartOfSpeech().capacity()
+           + word.getChinese().capacity();
+    for (const auto& category : word.getCategories()) {
+        bytes += sizeof(std::string) + category.capacity();
+    }
+    for (const auto& definition : word.getDefinitions()) {
+        bytes += sizeof(Word::Definition)
+               + definition.type.capacity() + definition.content.capacity();
+    }
+    return bytes;
+}
+
+void WordCache::evictOverflow() {
+    while (entries.size() > maxEntries) {
+        auto& oldest = entries.back();
+        memoryBytes -= oldest.bytes;
+        index.erase(oldest.word.getEnglish());
+        entries.pop_back();
+    }
+}
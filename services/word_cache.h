@@ -0,0 +1,82 @@
+#ifndef WORD_CACHE_H
+#define WORD_CACHE_H
+
+#include "../models/word.h"
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+// Bounded LRU cache of fully hydrated words keyed by their English text.
+// WordService reads through it and writes through it on add/update/delete,
+// so words that were just loaded are not fetched from SQLite again.
+//
+// Thread-safe; get() returns a copy so callers never hold a reference into
+// the cache.
+class WordCache {
+public:
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        size_t entries = 0;
+        size_t memoryBytes = 0;   // Estimated heap + object size of cached words
+
+        double hitRate() const {
+            uint64_t lookups = hits + misses;
+            return lookups > 0 ? static_cast<double>(hits) / lookups : 0.0;
+        }
+    };
+
+    explicit WordCache(size_t capacity = 2048);
+
+    WordCache(const WordCache&) = delete;
+    WordCache& operator=(const WordCache&) = delete;
+
+    std::optional<Word> get(const std::string& english);
+    bool contains(const std::string& english) const;
+    void put(const Word& word);
+    void erase(const std::string& english);
+    void clear();
+
+    // Read-through from another thread: take generation() before reading
+    // the database and pass it to putIfCurrent(), which drops the word if
+    // anything was erased, cleared or recorded meanwhile. A read racing an
+    // update or delete can then not put back the old row.
+    uint64_t generation() const;
+    void putIfCurrent(const Word& word, uint64_t generation);
+
+    // Applies an answer to the cached copy, mirroring Word::recordAttempt,
+    // so stats written straight to the database do not leave it stale.
+    void recordAttempt(const std::string& english, bool correct);
+
+    size_t capacity() const { return maxEntries; }
+    Stats stats() const;
+    void resetCounters();
+
+private:
+    struct Entry {
+        Word word;
+        size_t bytes;
+    };
+    using LruList = std::list<Entry>;
+
+    static size_t estimateSize(const Word& word);
+    // Expects the lock held
+    void insert(const Word& word, size_t bytes);
+    void evictOverflow();
+
+    const size_t maxEntries;
+    mutable std::mutex mutex;
+    LruList entries;   // Most recently used first
+    std::unordered_map<std::string, LruList::iterator> index;
+    size_t memoryBytes = 0;
+    // Bumped by erase, clear and recordAttempt
+    uint64_t changes = 0;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+};
+
+#endif // WORD_CACHE_H
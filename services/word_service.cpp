@@ -1,8 +1,27 @@
 #include "word_service.h"
+#include <QDebug>
 #include <stdexcept>
 
+namespace {
+    DistractorIndex::Entry toDistractorEntry(const Word& word) {
+        return {word.getEnglish(), word.getPartOfSpeech(), word.getChinese(),
+                word.getCategories()};
+    }
+}
+
 std::optional<Word> WordService::getWord(const std::string& english) {
-    return repository->findByEnglish(english);
+    if (auto cached = cache->get(english)) {
+        return cached;
+    }
+    
+    // getWordAsync runs this on a reader thread while the GUI thread may
+    // update or delete the word
+    const uint64_t generation = cache->generation();
+    auto word = repository->findByEnglish(english);
+    if (word) {
+        cache->putIfCurrent(*word, generation);
+    }
+    return word;
 }
 
 bool WordService::addWord(const Word& word) {
@@ -12,11 +31,18 @@ bool WordService::addWord(const Word& word) {
     }
     
     // Check if word already exists
-    if (repository->findByEnglish(word.getEnglish())) {
+    if (getWord(word.getEnglish())) {
         throw std::runtime_error("Word already exists");
     }
     
-    return repository->save(word);
+    if (!repository->save(word)) {
+        return false;
+    }
+    cache->put(word);
+    prefixIndex.insert(word.getEnglish());
+    updateDistractors(word.getEnglish(), toDistractorEntry(word));
+    notifyChanged(word.getEnglish());
+    return true;
 }
 
 bool WordService::updateWord(const Word& word) {
@@ -26,20 +52,144 @@ bool WordService::updateWord(const Word& word) {
     }
     
     // Check if word exists
-    if (!repository->findByEnglish(word.getEnglish())) {
+    if (!getWord(word.getEnglish())) {
         throw std::runtime_error("Word does not exist");
     }
     
-    return repository->update(word);
+    bool updated = repository->update(word);
+    // Reload on next use: a failed update may have written part of the row,
+    // and the stored counters may be newer than the caller's copy
+    cache->erase(word.getEnglish());
+    if (!updated) {
+        return false;
+    }
+    updateDistractors(word.getEnglish(), toDistractorEntry(word));
+    notifyChanged(word.getEnglish());
+    return true;
 }
 
 bool WordService::deleteWord(const std::string& english) {
     // Check if word exists
-    if (!repository->findByEnglish(english)) {
+    if (!getWord(english)) {
         throw std::runtime_error("Word does not exist");
     }
     
-    return repository->remove(english);
+    cache->erase(english);
+    if (!repository->remove(english)) {
+        return false;
+    }
+    prefixIndex.remove(english);
+    updateDistractors(english, std::nullopt);
+    notifyChanged(english);
+    return true;
+}
+
+std::vector<Word> WordService::searchWords(const std::string& text, int limit) {
+    if (limit <= 0) {
+        throw std::invalid_argument("Limit must be positive");
+    }
+    
+    return repository->search(text, limit);
+}
+
+std::vector<Word> WordService::getRandomWords(int count, const std::string& category,
+                                              const std::string& partOfSpeech) {
+    if (count <= 0) {
+        throw std::invalid_argument("Count must be positive");
+    }
+
+    return repository->sampleRandomWords(count, category, partOfSpeech);
+}
+
+void WordService::addChangeListener(std::function<void(const std::string&)> listener) {
+    changeListeners.push_back(std::move(listener));
+}
+
+void WordService::notifyChanged(const std::string& english) {
+    for (const auto& listener : changeListeners) {
+        listener(english);
+    }
+}
+
+void WordService::loadPrefixIndex() {
+    prefixIndex.build(repository->getAllHeadwords());
+}
+
+std::vector<std::string> WordService::findHeadwordsByPrefix(const std::string& prefix,
+                                                           size_t limit) const {
+    return prefixIndex.withPrefix(prefix, limit);
+}
+
+void WordService::loadDistractorIndex() {
+    distractorIndexPending = true;
+    pendingDistractorIndex = runOnReaders([this] {
+        std::vector<DistractorIndex::Entry> entries;
+        for (const auto& word : repository->getAllWordsWithCategories()) {
+            entries.push_back(toDistractorEntry(word));
+        }
+        auto index = std::make_shared<DistractorIndex>();
+        index->build(std::move(entries));
+        return index;
+    });
+}
+
+DistractorIndex* WordService::distractors() {
+    if (distractorIndexPending && pendingDistractorIndex.isFinished()) {
+        distractorIndexPending = false;
+        try {
+            distractorIndex = pendingDistractorIndex.result();
+            for (auto& change : queuedDistractorChanges) {
+                if (change.entry) {
+                    distractorIndex->insert(std::move(*change.entry));
+                } else {
+                    distractorIndex->remove(change.english);
+                }
+            }
+        } catch (const QException& e) {
+            qWarning() << "Could not build the distractor index:" << e.what();
+            distractorIndex.reset();
+        }
+        queuedDistractorChanges.clear();
+        pendingDistractorIndex = QFuture<std::shared_ptr<DistractorIndex>>();
+    }
+    return distractorIndex.get();
+}
+
+void WordService::updateDistractors(const std::string& english,
+                                    std::optional<DistractorIndex::Entry> entry) {
+    auto* index = distractors();
+    if (distractorIndexPending) {
+        // The build may have read the word before or after this change
+        queuedDistractorChanges.push_back({english, entry});
+    }
+    if (!index) return;
+    
+    if (entry) {
+        index->insert(std::move(*entry));
+    } else {
+        index->remove(english);
+    }
+}
+
+std::vector<Word> WordService::getDistractors(const std::string& english, size_t count) {
+    std::vector<Word> words;
+    auto* index = distractors();
+    if (!index) {
+        if (!distractorIndexPending) {
+            loadDistractorIndex();
+        }
+        return words;
+    }
+    
+    for (auto& entry : index->distractorsFor(english, count)) {
+        Word word(std::move(entry.english), std::move(entry.partOfSpeech),
+                  std::move(entry.chinese));
+        for (const auto& category : entry.categories) {
+            word.addCategory(category);
+        }
+        words.push_back(std::move(word));
+    }
+    return words;
 }
 
 std::vector<Word> WordService::getWordsForReview(const std::string& username, int count) {
@@ -55,14 +205,11 @@ std::vector<Word> WordService::getWordsForReview(const std::string& username, in
 }
 
 void WordService::recordWordAttempt(const std::string& english, bool correct) {
-    auto wordOpt = repository->findByEnglish(english);
-    if (!wordOpt) {
+    // Same deltas as Word::recordAttempt, applied in place
+    if (!repository->incrementStats(english, 1, correct ? 1 : 0, 1)) {
         throw std::runtime_error("Word does not exist");
     }
-    
-    Word word = *wordOpt;
-    word.recordAttempt(correct);
-    repository->update(word);
+    cache->recordAttempt(english, correct);
 }
 
 std::vector<Word> WordService::getDifficultWords(int limit) {
@@ -85,3 +232,41 @@ int WordService::getLearnedWordsCount(const std::string& username) {
 std::vector<Word> WordService::getAllWords() {
     return repository->getAllWords();
 }
+
+std::vector<Word> WordService::getWordPage(const std::string& after, int limit) {
+    if (limit <= 0) {
+        throw std::invalid_argument("Limit must be positive");
+    }
+    
+    return repository->findPageAfter(after, limit);
+}
+
+std::vector<Word> WordService::getWordRows(const std::vector<std::string>& englishWords) {
+    return repository->findRowsByEnglish(englishWords);
+}
+
+QFuture<std::optional<Word>> WordService::getWordAsync(const std::string& english) {
+    return runOnReaders([this, english] { return getWord(english); });
+}
+
+QFuture<std::vector<Word>> WordService::searchWordsAsync(const std::string& text, int limit) {
+    return runOnReaders([this, text, limit] { return searchWords(text, limit); });
+}
+
+QFuture<std::vector<Word>> WordService::getWordRowsAsync(
+    const std::vector<std::string>& englishWords) {
+    return runOnReaders([this, englishWords] { return getWordRows(englishWords); });
+}
+
+QFuture<std::vector<Word>> WordService::getWordsForReviewAsync(const std::string& username,
+                                                               int count) {
+    return runOnReaders([this, username, count] { return getWordsForReview(username, count); });
+}
+
+QFuture<std::vector<Word>> WordService::getDifficultWordsAsync(int limit) {
+    return runOnReaders([this, limit] { return getDifficultWords(limit); });
+}
+
+QFuture<std::vector<Word>> WordService::getAllWordsAsync() {
+    return runOnReaders([this] { return getAllWords(); });
+}
@@ -3,6 +3,12 @@
 
 #include "../repositories/word_repository.h"
 #include "../models/word.h"
+#include "async_task.h"
+#include "distractor_index.h"
+#include "prefix_index.h"
+#include "word_cache.h"
+#include <QFuture>
+#include <functional>
 #include <memory>
 #include <vector>
 #include <optional>
@@ -10,15 +16,56 @@
 class WordService {
 private:
     std::unique_ptr<WordRepository> repository;
+    std::unique_ptr<WordCache> cache;
+    PrefixIndex prefixIndex;
+    std::shared_ptr<DistractorIndex> distractorIndex;
+    QFuture<std::shared_ptr<DistractorIndex>> pendingDistractorIndex;
+    bool distractorIndexPending = false;
+    // Edits made while the index builds, replayed once it is adopted.
+    // No entry means the word was deleted.
+    struct DistractorChange {
+        std::string english;
+        std::optional<DistractorIndex::Entry> entry;
+    };
+    std::vector<DistractorChange> queuedDistractorChanges;
+    std::vector<std::function<void(const std::string&)>> changeListeners;
+
+    void notifyChanged(const std::string& english);
+    // The distractor index, adopting a finished build first. nullptr while
+    // the first build runs or if it was never started; never waits.
+    DistractorIndex* distractors();
+    void updateDistractors(const std::string& english,
+                           std::optional<DistractorIndex::Entry> entry);
 
 public:
-    WordService() : repository(std::make_unique<WordRepository>()) {}
+    WordService()
+        : repository(std::make_unique<WordRepository>()),
+          cache(std::make_unique<WordCache>()) {}
 
     // Core word operations
     std::optional<Word> getWord(const std::string& english);
     bool addWord(const Word& word);
     bool updateWord(const Word& word);
     bool deleteWord(const std::string& english);
+    std::vector<Word> searchWords(const std::string& text, int limit = 50);
+    // `count` distinct random words, optionally limited to a category
+    // and/or part of speech
+    std::vector<Word> getRandomWords(int count, const std::string& category = {},
+                                     const std::string& partOfSpeech = {});
+
+    // Headword completion from memory. loadPrefixIndex() reads all
+    // headwords once (at login); add/delete keep the index current.
+    void loadPrefixIndex();
+    std::vector<std::string> findHeadwordsByPrefix(const std::string& prefix, size_t limit = 50) const;
+
+    // Wrong answers for multiple-choice questions, from an index built on a
+    // reader thread. The first getDistractors() call starts the build, and
+    // until it finishes calls return no words rather than wait;
+    // loadDistractorIndex() starts it ahead of time. add/update/delete keep
+    // the index current, including during the build. Returns words without
+    // definitions.
+    void loadDistractorIndex();
+    std::vector<Word> getDistractors(const std::string& english, size_t count = 3);
 
     // Learning operations
     std::vector<Word> getWordsForReview(const std::string& username, int count = 10);
@@ -30,6 +77,26 @@ public:
     int getLearnedWordsCount(const std::string& username);
 
     std::vector<Word> getAllWords();
+    // Summary rows (no definitions or categories) for the vocabulary list
+    std::vector<Word> getWordPage(const std::string& after, int limit);
+    std::vector<Word> getWordRows(const std::vector<std::string>& englishWords);
+
+    // Async variants of the read operations. They run on the connection
+    // pool's reader threads; use whenFinished() to get the result back on
+    // the GUI thread. The prefix index is GUI-thread only and has none.
+    QFuture<std::optional<Word>> getWordAsync(const std::string& english);
+    QFuture<std::vector<Word>> searchWordsAsync(const std::string& text, int limit = 50);
+    QFuture<std::vector<Word>> getWordRowsAsync(const std::vector<std::string>& englishWords);
+    QFuture<std::vector<Word>> getWordsForReviewAsync(const std::string& username, int count = 10);
+    QFuture<std::vector<Word>> getDifficultWordsAsync(int limit = 10);
+    QFuture<std::vector<Word>> getAllWordsAsync();
+
+    // Called with the headword after a word is added, updated or deleted
+    void addChangeListener(std::function<void(const std::string&)> listener);
+
+    // Shared with ReviewService so answers recorded there reach cached words
+    WordCache* getCache() const { return cache.get(); }
+    WordCache::Stats getCacheStats() const { return cache->stats(); }
 };
 
 #endif // WORD_SERVICE_H
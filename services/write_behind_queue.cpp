@@ -0,0 +1,172 @@
+#include "write_behind_queue.h"
+#include <QDebug>
+
+WriteBehindQueue::WriteBehindQueue() : WriteBehindQueue(Options()) {}
+
+WriteBehindQueue::WriteBehindQueue(const Options& options)
+    : options(options),
+      userRepository(std::make_unique<UserRepository>()),
+      wordRepository(std::make_unique<WordRepository>()) {
+    // A QThread rather than std::thread, so the connection pool can close
+    // this thread's connection when it finishes.
+    writer.reset(QThread::create([this] { run(); }));
+    writer->start();
+}
+
+WriteBehindQueue::~WriteBehindQueue() {
+    stop();
+}
+
+void WriteBehindQueue::enqueueScore(const std::string& username, int points) {
+    if (points == 0) return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    pending.scores[username] += points;
+    pending.count++;
+    enqueuedSeq++;
+    if (pending.count >= options.maxPending) {
+        wake.notify_one();
+    }
+}
+
+void WriteBehindQueue::enqueueReviewResults(
+    const std::vector<WordRepository::ReviewResult>& results) {
+    if (results.empty()) return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    pending.results.insert(pending.results.end(), results.begin(), results.end());
+    pending.count += results.size();
+    enqueuedSeq++;
+    if (pending.count >= options.maxPending) {
+        wake.notify_one();
+    }
+}
+
+bool WriteBehindQueue::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    uint64_t target = enqueuedSeq;
+    if (writtenSeq >= target) {
+        return true;
+    }
+    if (stopping) {
+        return false;
+    }
+
+    uint64_t round = rounds;
+    flushRequested = true;
+    wake.notify_one();
+    written.wait(lock, [&] {
+        return writtenSeq >= target || (rounds > round && lastRoundFailed);
+    });
+    return writtenSeq >= target;
+}
+
+void WriteBehindQueue::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping) return;
+        stopping = true;
+    }
+    wake.notify_one();
+    writer->wait();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (pending.count > 0) {
+        qWarning() << "Write-behind queue stopped with" << pending.count
+                   << "unsaved writes";
+    }
+}
+
+size_t WriteBehindQueue::pendingCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return pending.count;
+}
+
+std::set<std::string> WriteBehindQueue::unwrittenWords(const std::string& username) const {
+    std::set<std::string> words;
+    auto collect = [&](const Batch& batch) {
+        for (const auto& result : batch.results) {
+            if (result.username == username) {
+                words.insert(result.english);
+            }
+        }
+    };
+    
+    std::lock_guard<std::mutex> lock(mutex);
+    collect(pending);
+    if (writing) {
+        collect(*writing);
+    }
+    return words;
+}
+
+void WriteBehindQueue::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait_for(lock, options.flushInterval, [this] {
+            return stopping || flushRequested || pending.count >= options.maxPending;
+        });
+
+        if (pending.count == 0) {
+            flushRequested = false;
+            writtenSeq = enqueuedSeq;
+            written.notify_all();
+            if (stopping) break;
+            continue;
+        }
+
+        Batch batch;
+        std::swap(batch, pending);
+        uint64_t target = enqueuedSeq;
+        flushRequested = false;
+        writing = &batch;
+
+        // write() only reads the batch, so unwrittenWords() may too
+        lock.unlock();
+        bool ok = write(batch);
+        lock.lock();
+        writing = nullptr;
+
+        if (ok) {
+            writtenSeq = target;
+        } else {
+            // Put the batch back in front of anything queued meanwhile
+            for (const auto& [username, points] : batch.scores) {
+                pending.scores[username] += points;
+            }
+            batch.results.insert(batch.results.end(),
+                                 pending.results.begin(), pending.results.end());
+            pending.results = std::move(batch.results);
+            pending.count += batch.count;
+        }
+        rounds++;
+        lastRoundFailed = !ok;
+        written.notify_all();
+
+        // On shutdown, give up after a failed final attempt
+        if (stopping && (!ok || pending.count == 0)) break;
+    }
+}
+
+bool WriteBehindQueue::write(const Batch& batch) {
+    try {
+        BaseRepository::TransactionGuard transaction;
+
+        for (const auto& [username, points] : batch.scores) {
+            if (!userRepository->addScore(username, points)) {
+                qDebug() << "Write-behind: could not add score for"
+                         << QString::fromStdString(username);
+                return false;
+            }
+        }
+
+        if (!wordRepository->recordResults(batch.results)) {
+            return false;
+        }
+
+        return transaction.commit();
+    } catch (const std::exception& e) {
+        qDebug() << "Write-behind flush failed:" << e.what();
+        return false;
+    }
+}
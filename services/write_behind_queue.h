@@ -0,0 +1,82 @@
+#ifndef WRITE_BEHIND_QUEUE_H
+#define WRITE_BEHIND_QUEUE_H
+
+#include "../repositories/user_repository.h"
+#include "../repositories/word_repository.h"
+#include <QThread>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+// Buffers score and review-result writes and persists them on a background
+// thread, so the GUI thread never waits on disk I/O mid-review. Pending
+// writes are flushed in one transaction once maxPending of them pile up or
+// flushInterval has passed, whichever comes first.
+//
+// Callers that need the database to be current (logout, full-row user
+// updates, shutdown) call flush(), which blocks until everything queued so
+// far has been written.
+class WriteBehindQueue {
+public:
+    struct Options {
+        size_t maxPending = 64;
+        std::chrono::milliseconds flushInterval{2000};
+    };
+
+    WriteBehindQueue();
+    explicit WriteBehindQueue(const Options& options);
+    ~WriteBehindQueue();
+
+    WriteBehindQueue(const WriteBehindQueue&) = delete;
+    WriteBehindQueue& operator=(const WriteBehindQueue&) = delete;
+
+    void enqueueScore(const std::string& username, int points);
+    void enqueueReviewResults(const std::vector<WordRepository::ReviewResult>& results);
+
+    // Returns false if the last write attempt failed; the writes stay queued
+    // and are retried on the next flush.
+    bool flush();
+    // Flushes and stops the writer thread. Called by the destructor.
+    void stop();
+
+    size_t pendingCount() const;
+    // Words whose review results for username are not committed yet:
+    // queued, or in a write still running. Never waits for the writer.
+    std::set<std::string> unwrittenWords(const std::string& username) const;
+
+private:
+    struct Batch {
+        std::map<std::string, int> scores;
+        std::vector<WordRepository::ReviewResult> results;
+        size_t count = 0;
+    };
+
+    void run();
+    bool write(const Batch& batch);
+
+    Options options;
+    std::unique_ptr<UserRepository> userRepository;
+    std::unique_ptr<WordRepository> wordRepository;
+
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable written;
+    Batch pending;
+    // The batch the writer is working on, outside the lock
+    const Batch* writing = nullptr;
+    uint64_t enqueuedSeq = 0;
+    uint64_t writtenSeq = 0;
+    uint64_t rounds = 0;
+    bool lastRoundFailed = false;
+    bool flushRequested = false;
+    bool stopping = false;
+    std::unique_ptr<QThread> writer;
+};
+
+#endif // WRITE_BEHIND_QUEUE_H
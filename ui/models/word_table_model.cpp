@@ -0,0 +1,121 @@
+#include "word_table_model.h"
+#include <QDebug>
+
+WordTableModel::WordTableModel(QObject* parent) : QAbstractTableModel(parent) {}
+
+void WordTableModel::setPageLoader(PageLoader pageLoader) {
+    beginResetModel();
+    rows.clear();
+    rows.shrinkToFit();
+    loader = std::move(pageLoader);
+    lastLoaded.clear();
+    exhausted = !loader;
+    endResetModel();
+}
+
+void WordTableModel::setWords(const std::vector<Word>& words) {
+    beginResetModel();
+    loader = nullptr;
+    lastLoaded.clear();
+    exhausted = true;
+    rows.clear();
+    rows.reserve(words.size());
+    for (const auto& word : words) {
+        addRow(word);
+    }
+    rows.shrinkToFit();
+    endResetModel();
+}
+
+std::string WordTableModel::englishAt(int row) const {
+    if (row < 0 || row >= static_cast<int>(rows.size())) return {};
+    return std::string(rows.english(row));
+}
+
+int WordTableModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : static_cast<int>(rows.size());
+}
+
+int WordTableModel::columnCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant WordTableModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || index.row() >= static_cast<int>(rows.size())) {
+        return QVariant();
+    }
+
+    auto row = static_cast<CompactWordStore::Index>(index.row());
+    auto text = [](std::string_view value) {
+        return QString::fromUtf8(value.data(), static_cast<int>(value.size()));
+    };
+    if (role == Qt::DisplayRole) {
+        switch (index.column()) {
+            case EnglishColumn: return text(rows.english(row));
+            case PartOfSpeechColumn: return text(rows.partOfSpeech(row));
+            case ChineseColumn: return text(rows.chinese(row));
+            case AccuracyColumn:
+                return QString::number(rows.accuracy(row) * 100, 'f', 1) + "%";
+            case AttemptsColumn: return rows.totalAttempts(row);
+            default: return QVariant();
+        }
+    }
+    if (role == Qt::TextAlignmentRole
+        && (index.column() == AccuracyColumn || index.column() == AttemptsColumn)) {
+        return QVariant(Qt::AlignRight | Qt::AlignVCenter);
+    }
+    return QVariant();
+}
+
+QVariant WordTableModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (role != Qt::DisplayRole || orientation != Qt::Horizontal) {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+
+    switch (section) {
+        case EnglishColumn: return "英文";
+        case PartOfSpeechColumn: return "词性";
+        case ChineseColumn: return "中文";
+        case AccuracyColumn: return "正确率";
+        case AttemptsColumn: return "复习次数";
+        default: return QVariant();
+    }
+}
+
+bool WordTableModel::canFetchMore(const QModelIndex& parent) const {
+    return !parent.isValid() && !exhausted;
+}
+
+void WordTableModel::fetchMore(const QModelIndex& parent) {
+    if (parent.isValid() || exhausted) return;
+
+    auto page = loader(lastLoaded, kPageSize);
+    exhausted = static_cast<int>(page.size()) < kPageSize;
+    if (!page.empty()) {
+        // Advance even if none of the page is listed, so the next call
+        // does not load it again
+        lastLoaded = page.back().getEnglish();
+    }
+    int count = static_cast<int>(rows.countFitting(page));
+    if (count == 0) return;
+
+    int first = static_cast<int>(rows.size());
+    beginInsertRows(QModelIndex(), first, first + count - 1);
+    for (const auto& word : page) {
+        addRow(word);
+    }
+    if (exhausted) {
+        rows.shrinkToFit();
+    }
+    endInsertRows();
+}
+
+void WordTableModel::addRow(const Word& word) {
+    // Only a corrupt row could be this large; leave it out of the list
+    if (!rows.fits(word)) {
+        qWarning() << "Word too large to list:"
+                   << QString::fromStdString(word.getEnglish().substr(0, 64));
+        return;
+    }
+    rows.add(word);
+}
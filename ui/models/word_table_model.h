@@ -0,0 +1,63 @@
+#ifndef WORD_TABLE_MODEL_H
+#define WORD_TABLE_MODEL_H
+
+#include <QAbstractTableModel>
+#include <functional>
+#include <string>
+#include <vector>
+#include "../../models/compact_word_store.h"
+#include "../../models/word.h"
+
+// Table model for the vocabulary list. Rows live in a CompactWordStore;
+// cell values are formatted on demand in data(), so no per-cell objects
+// exist. In paged mode rows arrive page by page through fetchMore() as the
+// view scrolls, so opening a large deck reads only the first screenful.
+class WordTableModel : public QAbstractTableModel {
+    Q_OBJECT
+
+public:
+    enum Column {
+        EnglishColumn,
+        PartOfSpeechColumn,
+        ChineseColumn,
+        AccuracyColumn,
+        AttemptsColumn,
+        ColumnCount
+    };
+
+    // Returns up to `limit` words ordered by english, after `after`
+    // (from the start when empty). Fewer than `limit` means the end.
+    using PageLoader = std::function<std::vector<Word>(const std::string& after, int limit)>;
+
+    static constexpr int kPageSize = 256;
+
+    explicit WordTableModel(QObject* parent = nullptr);
+
+    // Paged mode: clears the model; rows are loaded by fetchMore()
+    void setPageLoader(PageLoader loader);
+    // Fixed mode: shows exactly these words, e.g. search results
+    void setWords(const std::vector<Word>& words);
+
+    std::string englishAt(int row) const;
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation,
+                        int role = Qt::DisplayRole) const override;
+
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+
+private:
+    void addRow(const Word& word);
+
+    CompactWordStore rows;
+    PageLoader loader;
+    // english of the last word loaded, listed or not; the next page starts
+    // after it
+    std::string lastLoaded;
+    bool exhausted = true;
+};
+
+#endif // WORD_TABLE_MODEL_H
@@ -9,6 +9,7 @@ ReviewView::ReviewView(ReviewService* rService, UserService* uService, QWidget*
       isAnswerShown(false), isAnswerChecked(false) {
     setupUi();
     connectSignals();
+    updateDueCount();
     
     timer = new QTimer(this);
     timer->setInterval(1000);  // Update every second
@@ -64,10 +65,12 @@ void ReviewView::setupUi() {
     accuracyLabel = new QLabel("正确率: 0%", statsArea);
     timeLabel = new QLabel("时间: 00:00", statsArea);
     progressLabel = new QLabel("进度: 0/0", statsArea);
+    dueLabel = new QLabel("今日待复习: 0", statsArea);
     
     statsLayout->addWidget(accuracyLabel);
     statsLayout->addWidget(timeLabel);
     statsLayout->addWidget(progressLabel);
+    statsLayout->addWidget(dueLabel);
     
     // Add all components to main layout
     mainLayout->addWidget(wordArea);
@@ -88,15 +91,24 @@ void ReviewView::connectSignals() {
 }
 
 void ReviewView::startNewSession(int wordCount) {
-    try {
-        reviewService->startNewSession(userService->getCurrentUser().getUsername(), wordCount);
-        timer->start();
-        showWord();
-        updateStatistics();
-    } catch (const std::exception& e) {
-        QMessageBox::warning(this, "错误",
-            QString("无法开始复习会话: %1").arg(e.what()));
-    }
+    // Usually the cards were prefetched and are ready; otherwise they are
+    // loaded on a reader thread and the session starts when they arrive
+    auto username = userService->getCurrentUser().getUsername();
+    whenFinished(this, reviewService->nextSessionAsync(username, wordCount),
+        [this](ReviewService::PreparedSession prepared) {
+            try {
+                reviewService->startSession(std::move(prepared));
+                timer->start();
+                showWord();
+                updateStatistics();
+            } catch (const std::exception& e) {
+                QMessageBox::warning(this, "错误",
+                    QString("无法开始复习会话: %1").arg(e.what()));
+            }
+        },
+        [this](const QString& error) {
+            QMessageBox::warning(this, "错误", QString("无法开始复习会话: %1").arg(error));
+        });
 }
 
 void ReviewView::showWord() {
@@ -105,6 +117,7 @@ void ReviewView::showWord() {
     const Word& word = reviewService->getCurrentWord();
     wordLabel->setText(QString::fromStdString(word.getEnglish()));
     partOfSpeechLabel->setText(QString::fromStdString(word.getPartOfSpeech()));
+    answerKey = AnswerGrader::prepare(word.getChinese());
     
     isAnswerShown = false;
     isAnswerChecked = false;
@@ -118,14 +131,16 @@ void ReviewView::showWord() {
 void ReviewView::checkAnswer() {
     if (!reviewService->hasActiveSession() || isAnswerChecked) return;
     
-    const Word& word = reviewService->getCurrentWord();
-    QString userAnswer = answerInput->text().trimmed();
-    QString correctAnswer = QString::fromStdString(word.getChinese());
-    
-    bool isCorrect = (userAnswer == correctAnswer);
+    // Any one meaning counts, and small typos are forgiven
+    auto grade = answerGrader.grade(answerInput->text().toStdString(), answerKey);
+    bool isCorrect = grade.correct;
     reviewService->recordAttempt(isCorrect);
     
     if (isCorrect) {
+        if (grade.distance > 0) {
+            // Show the meaning that was meant, spelled correctly
+            answerInput->setText(QString::fromStdString(grade.matched));
+        }
         answerInput->setStyleSheet("QLineEdit { background-color: #d4edda; }");
         userService->addScore(10);  // Award points for correct answer
     } else {
@@ -176,6 +191,7 @@ void ReviewView::endSession() {
     int correctWords = reviewService->getCorrectCount();
     
     reviewService->endSession();
+    updateDueCount();
     
     QString message = QString(
         "复习会话结束!\n"
@@ -193,6 +209,7 @@ void ReviewView::endSession() {
 }
 
 void ReviewView::updateStatistics() {
+    updateDueCount();
     if (!reviewService->hasActiveSession()) return;
     
     accuracyLabel->setText(QString("正确率: %.1f%%")
@@ -203,6 +220,12 @@ void ReviewView::updateStatistics() {
         .arg(reviewService->getReviewedItems().size()));
 }
 
+void ReviewView::updateDueCount() {
+    // Counted in memory by the due queue; cheap enough for every answer
+    auto username = userService->getCurrentUser().getUsername();
+    dueLabel->setText(QString("今日待复习: %1").arg(reviewService->countDueToday(username)));
+}
+
 void ReviewView::updateTimer() {
     if (!reviewService->hasActiveSession()) return;
     
@@ -6,6 +6,7 @@
 #include <QLineEdit>
 #include <QPushButton>
 #include <QTimer>
+#include "../../services/answer_grader.h"
 #include "../../services/review_service.h"
 #include "../../services/user_service.h"
 
@@ -28,15 +29,19 @@ private:
     QLabel* accuracyLabel;
     QLabel* timeLabel;
     QLabel* progressLabel;
+    QLabel* dueLabel;
     QTimer* timer;
     
     // Session state
     bool isAnswerShown;
     bool isAnswerChecked;
+    AnswerGrader answerGrader;
+    AnswerGrader::AnswerKey answerKey;   // Meanings of the current word
     
     void setupUi();
     void connectSignals();
     void updateStatistics();
+    void updateDueCount();
     void showWord();
     void clearInput();
     void checkAnswer();
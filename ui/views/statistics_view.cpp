@@ -66,6 +66,7 @@ void StatisticsView::createOverviewSection() {
     accuracyLabel = new QLabel(overviewGroup);
     streakLabel = new QLabel(overviewGroup);
     scoreLabel = new QLabel(overviewGroup);
+    dueTodayLabel = new QLabel(overviewGroup);
     
     // Style labels
     QFont statFont = font();
@@ -73,7 +74,7 @@ void StatisticsView::createOverviewSection() {
     statFont.setBold(true);
     
     for (auto* label : {totalWordsLabel, masteredWordsLabel, learningWordsLabel,
-                       accuracyLabel, streakLabel, scoreLabel}) {
+                       accuracyLabel, streakLabel, scoreLabel, dueTodayLabel}) {
         label->setFont(statFont);
         label->setAlignment(Qt::AlignCenter);
         overviewLayout->addWidget(label);
@@ -135,6 +136,9 @@ void StatisticsView::createTables() {
 }
 
 void StatisticsView::refreshStats() {
+    // Each section is loaded on the reader threads and filled in as soon as
+    // its own data arrives. Results of an older refresh are dropped.
+    ++refreshGeneration;
     updateOverview();
     updateCharts();
     updateTables();
@@ -142,70 +146,114 @@ void StatisticsView::refreshStats() {
 
 void StatisticsView::updateOverview() {
     auto username = userService->getCurrentUser().getUsername();
-    auto progress = statisticsService->getUserProgress(username);
-    
-    totalWordsLabel->setText(QString("总单词数\n%1").arg(progress.totalWords));
-    masteredWordsLabel->setText(QString("已掌握\n%1").arg(progress.masteredWords));
-    learningWordsLabel->setText(QString("学习中\n%1").arg(progress.learningWords));
-    accuracyLabel->setText(QString("总正确率\n%.1f%").arg(progress.overallAccuracy * 100));
-    streakLabel->setText(QString("连续学习\n%1天").arg(progress.daysStreak));
-    scoreLabel->setText(QString("总分数\n%1").arg(progress.totalScore));
+    int generation = refreshGeneration;
+    
+    // Answered from the in-memory due queue, so no need to wait for it
+    dueTodayLabel->setText(QString("今日待复习\n%1")
+        .arg(statisticsService->countDueToday(username)));
+    
+    // The overview labels and the progress pie share one query
+    whenFinished(this, statisticsService->getUserProgressAsync(username),
+        [this, generation](const StatisticsService::UserProgress& progress) {
+            if (generation != refreshGeneration) return;
+            
+            totalWordsLabel->setText(QString("总单词数\n%1").arg(progress.totalWords));
+            masteredWordsLabel->setText(QString("已掌握\n%1").arg(progress.masteredWords));
+            learningWordsLabel->setText(QString("学习中\n%1").arg(progress.learningWords));
+            accuracyLabel->setText(QString("总正确率\n%1%")
+                .arg(QString::number(progress.overallAccuracy * 100, 'f', 1)));
+            streakLabel->setText(QString("连续学习\n%1天").arg(progress.daysStreak));
+            scoreLabel->setText(QString("总分数\n%1").arg(progress.totalScore));
+            
+            progressPieChart->chart()->removeAllSeries();
+            progressPieChart->chart()->addSeries(createProgressPieSeries(progress));
+        },
+        [this](const QString& error) { showLoadError(error); });
 }
 
 void StatisticsView::updateCharts() {
-    // Update progress pie chart
-    auto pieSeries = createProgressPieSeries();
-    progressPieChart->chart()->removeAllSeries();
-    progressPieChart->chart()->addSeries(pieSeries);
+    auto username = userService->getCurrentUser().getUsername();
+    int generation = refreshGeneration;
+    
+    // Progress pie chart is filled in by updateOverview
     
     // Update accuracy trend chart
-    auto lineSeries = createAccuracyTrendSeries();
-    accuracyTrendChart->chart()->removeAllSeries();
-    accuracyTrendChart->chart()->addSeries(lineSeries);
-    
-    // Add axes for accuracy trend
-    auto axisX = new QDateTimeAxis;
-    axisX->setFormat("MM-dd");
-    axisX->setTitleText("日期");
-    accuracyTrendChart->chart()->addAxis(axisX, Qt::AlignBottom);
-    lineSeries->attachAxis(axisX);
-    
-    auto axisY = new QValueAxis;
-    axisY->setRange(0, 100);
-    axisY->setTitleText("正确率 (%)");
-    accuracyTrendChart->chart()->addAxis(axisY, Qt::AlignLeft);
-    lineSeries->attachAxis(axisY);
+    whenFinished(this, statisticsService->getDailyStatsAsync(username),
+        [this, generation](const std::vector<StatisticsService::DailyStats>& dailyStats) {
+            if (generation != refreshGeneration) return;
+            
+            auto* chart = accuracyTrendChart->chart();
+            auto lineSeries = createAccuracyTrendSeries(dailyStats);
+            chart->removeAllSeries();
+            for (auto* axis : chart->axes()) {
+                chart->removeAxis(axis);
+                delete axis;
+            }
+            chart->addSeries(lineSeries);
+            
+            // Add axes for accuracy trend
+            auto axisX = new QDateTimeAxis;
+            axisX->setFormat("MM-dd");
+            axisX->setTitleText("日期");
+            chart->addAxis(axisX, Qt::AlignBottom);
+            lineSeries->attachAxis(axisX);
+            
+            auto axisY = new QValueAxis;
+            axisY->setRange(0, 100);
+            axisY->setTitleText("正确率 (%)");
+            chart->addAxis(axisY, Qt::AlignLeft);
+            lineSeries->attachAxis(axisY);
+            
+            updateRecentActivity(dailyStats);
+        },
+        [this](const QString& error) { showLoadError(error); });
     
     // Update category distribution chart
-    auto barSeries = createCategoryDistributionSeries();
-    categoryDistributionChart->chart()->removeAllSeries();
-    categoryDistributionChart->chart()->addSeries(barSeries);
+    whenFinished(this, statisticsService->getWordsByCategoryAsync(),
+        [this, generation](const std::map<std::string, int>& categories) {
+            if (generation != refreshGeneration) return;
+            
+            categoryDistributionChart->chart()->removeAllSeries();
+            categoryDistributionChart->chart()->addSeries(
+                createCategoryDistributionSeries(categories));
+        },
+        [this](const QString& error) { showLoadError(error); });
 }
 
 void StatisticsView::updateTables() {
-    auto username = userService->getCurrentUser().getUsername();
+    int generation = refreshGeneration;
     
-    // Update difficult words table
-    auto difficultWords = statisticsService->getMostDifficultWords(10);
-    difficultWordsTable->setRowCount(difficultWords.size());
-    
-    for (size_t i = 0; i < difficultWords.size(); ++i) {
-        const auto& word = difficultWords[i];
-        difficultWordsTable->setItem(i, 0, new QTableWidgetItem(
-            QString::fromStdString(word.english)));
-        difficultWordsTable->setItem(i, 1, new QTableWidgetItem(
-            QString::fromStdString(word.chinese)));
-        difficultWordsTable->setItem(i, 2, new QTableWidgetItem(
-            QString::number(word.accuracy * 100, 'f', 1) + "%"));
-        
-        auto lastReview = QDateTime::fromTime_t(
-            std::chrono::system_clock::to_time_t(word.lastReview));
-        difficultWordsTable->setItem(i, 3, new QTableWidgetItem(
-            lastReview.toString("yyyy-MM-dd HH:mm")));
-    }
+    // Recent activity is filled in with the accuracy trend, from the same
+    // daily stats
     
-    // Update recent activity table
-    auto dailyStats = statisticsService->getDailyStats(username);
+    // Update difficult words table
+    whenFinished(this, statisticsService->getMostDifficultWordsAsync(10),
+        [this, generation](const std::vector<StatisticsService::WordStats>& difficultWords) {
+            if (generation != refreshGeneration) return;
+            
+            difficultWordsTable->setRowCount(difficultWords.size());
+            
+            for (size_t i = 0; i < difficultWords.size(); ++i) {
+                const auto& word = difficultWords[i];
+                difficultWordsTable->setItem(i, 0, new QTableWidgetItem(
+                    QString::fromStdString(word.english)));
+                difficultWordsTable->setItem(i, 1, new QTableWidgetItem(
+                    QString::fromStdString(word.chinese)));
+                difficultWordsTable->setItem(i, 2, new QTableWidgetItem(
+                    QString::number(word.accuracy * 100, 'f', 1) + "%"));
+                
+                auto lastReview = QDateTime::fromTime_t(
+                    std::chrono::system_clock::to_time_t(word.lastReview));
+                difficultWordsTable->setItem(i, 3, new QTableWidgetItem(
+                    lastReview.toString("yyyy-MM-dd HH:mm")));
+            }
+            difficultWordsTable->resizeColumnsToContents();
+        },
+        [this](const QString& error) { showLoadError(error); });
+}
+
+void StatisticsView::updateRecentActivity(
+    const std::vector<StatisticsService::DailyStats>& dailyStats) {
     recentActivityTable->setRowCount(dailyStats.size());
     
     for (size_t i = 0; i < dailyStats.size(); ++i) {
@@ -223,14 +271,19 @@ void StatisticsView::updateTables() {
             QString::number(stat.accuracy * 100, 'f', 1) + "%"));
     }
     
-    difficultWordsTable->resizeColumnsToContents();
     recentActivityTable->resizeColumnsToContents();
 }
 
-QPieSeries* StatisticsView::createProgressPieSeries() {
-    auto username = userService->getCurrentUser().getUsername();
-    auto progress = statisticsService->getUserProgress(username);
-    
+void StatisticsView::showLoadError(const QString& error) {
+    // Several sections may fail together; report the first one only
+    if (loadErrorShown) return;
+    loadErrorShown = true;
+    QMessageBox::warning(this, "错误", QString("加载统计数据失败: %1").arg(error));
+    loadErrorShown = false;
+}
+
+QPieSeries* StatisticsView::createProgressPieSeries(
+    const StatisticsService::UserProgress& progress) {
     auto* series = new QPieSeries();
     series->append("已掌握", progress.masteredWords);
     series->append("学习中", progress.learningWords);
@@ -239,10 +292,8 @@ QPieSeries* StatisticsView::createProgressPieSeries() {
     return series;
 }
 
-QLineSeries* StatisticsView::createAccuracyTrendSeries() {
-    auto username = userService->getCurrentUser().getUsername();
-    auto dailyStats = statisticsService->getDailyStats(username);
-    
+QLineSeries* StatisticsView::createAccuracyTrendSeries(
+    const std::vector<StatisticsService::DailyStats>& dailyStats) {
     auto* series = new QLineSeries();
     
     for (const auto& stats : dailyStats) {
@@ -253,9 +304,8 @@ QLineSeries* StatisticsView::createAccuracyTrendSeries() {
     return series;
 }
 
-QBarSeries* StatisticsView::createCategoryDistributionSeries() {
-    auto categories = statisticsService->getWordsByCategory();
-    
+QBarSeries* StatisticsView::createCategoryDistributionSeries(
+    const std::map<std::string, int>& categories) {
     auto* series = new QBarSeries();
     auto* set = new QBarSet("单词数");
     
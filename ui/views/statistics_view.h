@@ -27,6 +27,7 @@ private:
     QLabel* accuracyLabel;
     QLabel* streakLabel;
     QLabel* scoreLabel;
+    QLabel* dueTodayLabel;
     
     // Chart views
     QChartView* progressPieChart;
@@ -42,15 +43,23 @@ private:
     void createCharts();
     void createTables();
     
+    // Bumped by refreshStats; async results from older refreshes are dropped
+    int refreshGeneration = 0;
+    bool loadErrorShown = false;
+    
     // Chart creation helpers
-    QPieSeries* createProgressPieSeries();
-    QLineSeries* createAccuracyTrendSeries();
-    QBarSeries* createCategoryDistributionSeries();
+    QPieSeries* createProgressPieSeries(const StatisticsService::UserProgress& progress);
+    QLineSeries* createAccuracyTrendSeries(
+        const std::vector<StatisticsService::DailyStats>& dailyStats);
+    QBarSeries* createCategoryDistributionSeries(const std::map<std::string, int>& categories);
     
-    // Data update methods
+    // Data update methods. Each starts its queries on the reader threads
+    // and fills its widgets when the results arrive.
     void updateOverview();
     void updateCharts();
     void updateTables();
+    void updateRecentActivity(const std::vector<StatisticsService::DailyStats>& dailyStats);
+    void showLoadError(const QString& error);
     
 private slots:
     void onRefreshClicked();
@@ -3,8 +3,8 @@
 #include <QHBoxLayout>
 #include <QHeaderView>
 #include <QMessageBox>
-#include <QStandardItemModel>
 #include "../dialogs/word_dialog.h"
+#include "../models/word_table_model.h"
 
 VocabularyView::VocabularyView(WordService* service, QWidget* parent)
     : QWidget(parent), wordService(service) {
@@ -33,6 +33,9 @@ void VocabularyView::setupUi() {
     wordTable->setSelectionMode(QAbstractItemView::SingleSelection);
     wordTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
     wordTable->horizontalHeader()->setStretchLastSection(true);
+    wordTable->horizontalHeader()->setResizeContentsPrecision(kColumnSizingSample);
+    wordModel = new WordTableModel(this);
+    wordTable->setModel(wordModel);
     
     // Action buttons
     auto* buttonLayout = new QHBoxLayout();
@@ -69,24 +72,38 @@ void VocabularyView::connectSignals() {
 }
 
 void VocabularyView::refreshWordList() {
-    auto* model = new QStandardItemModel(this);
-    model->setHorizontalHeaderLabels({"英文", "词性", "中文", "正确率", "复习次数"});
-    
-    // TODO: Get filtered words based on search and category
-    std::vector<Word> words = wordService->getAllWords();
-    
-    for (const auto& word : words) {
-        QList<QStandardItem*> row;
-        row.append(new QStandardItem(QString::fromStdString(word.getEnglish())));
-        row.append(new QStandardItem(QString::fromStdString(word.getPartOfSpeech())));
-        row.append(new QStandardItem(QString::fromStdString(word.getChinese())));
-        row.append(new QStandardItem(QString::number(word.getStats().getAccuracy() * 100, 'f', 1) + "%"));
-        row.append(new QStandardItem(QString::number(word.getStats().totalAttempts)));
-        model->appendRow(row);
+    // TODO: Filter by category
+    QString searchText = searchBox->text().trimmed();
+    int generation = ++searchGeneration;
+    if (searchText.isEmpty()) {
+        // The whole deck, paged in as the table scrolls
+        wordModel->setPageLoader([service = wordService](const std::string& after, int limit) {
+            return service->getWordPage(after, limit);
+        });
+        wordModel->fetchMore(QModelIndex());
+        
+        // Size columns from a sample of rows rather than measuring all of them
+        wordTable->resizeColumnsToContents();
+        return;
     }
     
-    wordTable->setModel(model);
-    wordTable->resizeColumnsToContents();
+    // Headword prefixes resolve in memory; only text that starts no
+    // headword (Chinese, words from a definition) needs the full-text index.
+    // Rows are read on a reader thread; a newer keystroke supersedes them.
+    auto headwords = wordService->findHeadwordsByPrefix(searchText.toStdString(),
+                                                        kMaxSearchResults);
+    auto rows = headwords.empty()
+        ? wordService->searchWordsAsync(searchText.toStdString(), kMaxSearchResults)
+        : wordService->getWordRowsAsync(headwords);
+    whenFinished(this, rows,
+        [this, generation](const std::vector<Word>& words) {
+            if (generation != searchGeneration) return;
+            wordModel->setWords(words);
+            wordTable->resizeColumnsToContents();
+        },
+        [this](const QString& error) {
+            QMessageBox::warning(this, "错误", QString("搜索失败: %1").arg(error));
+        });
 }
 
 void VocabularyView::showAddWordDialog() {
@@ -110,8 +127,7 @@ void VocabularyView::showEditWordDialog() {
     auto selection = wordTable->selectionModel()->selectedRows();
     if (selection.isEmpty()) return;
     
-    QString english = wordTable->model()->data(selection[0]).toString();
-    auto wordOpt = wordService->getWord(english.toStdString());
+    auto wordOpt = wordService->getWord(wordModel->englishAt(selection[0].row()));
     
     if (!wordOpt) {
         QMessageBox::warning(this, "错误", "找不到选中的单词");
@@ -138,7 +154,7 @@ void VocabularyView::confirmDeleteWord() {
     auto selection = wordTable->selectionModel()->selectedRows();
     if (selection.isEmpty()) return;
     
-    QString english = wordTable->model()->data(selection[0]).toString();
+    QString english = QString::fromStdString(wordModel->englishAt(selection[0].row()));
     
     auto reply = QMessageBox::question(this, "确认删除",
         QString("确定要删除单词 '%1' 吗？").arg(english),
@@ -159,7 +175,6 @@ void VocabularyView::confirmDeleteWord() {
 }
 
 void VocabularyView::onSearchTextChanged(const QString& /*text*/) {
-    // TODO: Implement search filtering
     refreshWordList();
 }
 
@@ -7,13 +7,21 @@
 #include <QLineEdit>
 #include <QComboBox>
 #include "../../services/word_service.h"
+#include "../models/word_table_model.h"
 
 class VocabularyView : public QWidget {
     Q_OBJECT
 
 private:
+    static constexpr int kMaxSearchResults = 200;
+    // Rows measured when sizing columns to their contents
+    static constexpr int kColumnSizingSample = 100;
+
     WordService* wordService;
     QTableView* wordTable;
+    WordTableModel* wordModel;
+    // Bumped per refresh; late search results of older ones are dropped
+    int searchGeneration = 0;
     QLineEdit* searchBox;
     QComboBox* categoryFilter;
     QPushButton* addButton;